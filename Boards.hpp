@@ -4,6 +4,131 @@
 #include "MyStm32.hpp"
 #include "Gpio.hpp"
 
+/*=============================================================
+    PinCfg - one pin's configuration, for use in a PinMap table
+    (members in the same order as used in an initializer list,
+     only the pin and mode are required)
+
+    { PINS::PC6, PINS::OUTPUT }
+    { PINS::PA2, PINS::ALTERNATE, PINS::PULLUP, PINS::AF1 }
+=============================================================*/
+struct PinCfg {
+    PINS::PIN       pin;
+    PINS::MODE      mode;
+    PINS::PULL      pull    { PINS::NOPULL };
+    PINS::ALTFUNC   altFunc { PINS::AF0 };
+    PINS::SPEED     speed   { PINS::SPEED0 };
+    PINS::OTYPE     outType { PINS::PUSHPULL };
+    bool            high    { false };          //initial output latch
+    bool            lock    { false };
+    };
+
+/*=============================================================
+    PinMap - compile time pin configuration
+
+    a constexpr table of PinCfg is folded into per port register
+    values and masks at compile time, and apply() then writes each
+    port register once (a single masked update per register instead
+    of a read-modify-write for every pin and every property)
+
+    pins not in the table are left as-is, so more than one table
+    can be applied
+
+    static constexpr PinCfg myPins[]{ ... };
+    PinMap<myPins>::apply();
+
+    the board table is applied by startup.cpp on every reset (boardInit),
+    before any c++ constructors run (so no construction order
+    dependencies)- to do the same for an app table, call from preinit()
+    which startup.cpp runs right after boardInit (define it once, in
+    the app .cpp), and tell drivers using those pins not to configure
+    them in their constructor (pinInit = false)-
+
+    void preinit(){ PinMap<myPins>::apply(); }
+=============================================================*/
+template<const auto& Tbl_>
+struct PinMap {
+
+//-------------|
+    private:
+//-------------|
+
+                SCA PORTS_{ 6 }; //A,B,C,D,E(not on this mcu),F
+
+                struct PortCfg {
+                    u16 used, high, lock;
+                    u32 m2, m4[2];  //masks for 2bit and 4bit fields
+                    u32 moder, otyper, ospeedr, pupdr, afr[2];
+                    };
+
+                //fold the table into per port register values/masks
+                static constexpr auto ports_{
+                    []{
+                    struct { PortCfg p[PORTS_]; } t{};
+                    for( auto& c : Tbl_ ){
+                        auto& r = t.p[c.pin/16];
+                        u32 pin = c.pin%16, bp2 = 2*pin, bp4 = 4*(pin bitand 7);
+                        r.used or_eq 1<<pin;
+                        if( c.high ) r.high or_eq 1<<pin;
+                        if( c.lock ) r.lock or_eq 1<<pin;
+                        if( c.outType == PINS::ODRAIN ) r.otyper or_eq 1<<pin;
+                        r.m2 or_eq 3u<<bp2;
+                        r.m4[pin/8] or_eq 15u<<bp4;
+                        r.moder or_eq c.mode<<bp2;
+                        r.ospeedr or_eq c.speed<<bp2;
+                        r.pupdr or_eq c.pull<<bp2;
+                        r.afr[pin/8] or_eq c.altFunc<<bp4;
+                        }
+                    return t;
+                    }()
+                    };
+
+                //port clock enable bits for all ports used
+                SCA iopen_{
+                    []{ u32 bm = 0;
+                        for( auto port = 0u; port < PORTS_; port++ ) if( ports_.p[port].used ) bm or_eq 1<<port;
+                        return bm; }()
+                    };
+
+                II static GPIO_TypeDef&
+reg             (u32 port) { return *(GPIO_TypeDef*)(GPIOA_BASE + (GPIOB_BASE-GPIOA_BASE)*port); }
+
+                II static void
+update          (volatile u32& r, u32 m, u32 v) { r = (r bitand compl m) bitor v; }
+
+//-------------|
+    public:
+//-------------|
+
+                //write each register of each port used in the table once
+                //(latch and pin properties first, mode last)
+                static void
+apply           ()
+                {
+                RCC->IOPENR or_eq iopen_;
+                for( auto port = 0u; port < PORTS_; port++ ){
+                    auto& c = ports_.p[port];
+                    if( not c.used ) continue;
+                    auto& r = reg(port);
+                    r.BSRR = ((u32)(c.used bitand compl c.high)<<16) bitor c.high;
+                    update( r.OTYPER, c.used, c.otyper );
+                    update( r.OSPEEDR, c.m2, c.ospeedr );
+                    update( r.PUPDR, c.m2, c.pupdr );
+                    if( c.m4[0] ) update( r.AFR[0], c.m4[0], c.afr[0] );
+                    if( c.m4[1] ) update( r.AFR[1], c.m4[1], c.afr[1] );
+                    update( r.MODER, c.m2, c.moder );
+                    if( c.lock ){
+                        u32 vL = (1<<16) bitor c.lock;
+                        r.LCKR = vL;
+                        r.LCKR = c.lock;
+                        r.LCKR = vL;
+                        (void)r.LCKR; //read required to complete sequence
+                        }
+                    }
+                }
+
+};
+
 /*=============================================================
     Boards
 =============================================================*/
@@ -14,8 +139,16 @@ struct Boards {
         //Uart2, TX=PA2,RX=PA3
         static constexpr uartT uart{ Uart2_A2A3 };
 
-        //fixed green led- LD3
-        GpioPin led{ GpioPin(PINS::PC6).mode(PINS::OUTPUT).lock().off() };
+        //fixed green led- LD3 (compile time pin, no ram used)
+        //(configured by the pins table below, which startup always
+        // applies, so clock enable not needed)
+        static constexpr GpioPinT<PINS::PC6> led{ false };
+
+        //board pin configuration, applied before constructors run
+        static constexpr PinCfg pins[]{
+            { PINS::PC6, PINS::OUTPUT, PINS::NOPULL, PINS::AF0, PINS::SPEED0, PINS::PUSHPULL, false, true }, //led, off, locked
+            { uart.txPin, PINS::ALTERNATE, PINS::PULLUP, uart.txAltFunc },  //uart tx, pullup for when tx not enabled
+            };
 
         //board pin labels to actual pins
         static constexpr PINS::PIN D[]{ //0-12
@@ -33,3 +166,9 @@ struct Boards {
 
 };
 
+//board pins, called by startup.cpp (not a weak hook, so always done)
+//before any c++ constructors- used so it is emitted even though only
+//startup.cpp calls it
+                [[ gnu::used ]] inline void
+boardInit       () { PinMap<Boards::Nucleo32g031::pins>::apply(); }
+
@@ -0,0 +1,127 @@
+#pragma once //Debounce.hpp
+
+#include "MyStm32.hpp"
+
+/*=============================================================
+    Debounce - timer sampled debounce for many input pins
+
+    sample() is called at a fixed rate (from some timer isr, 2-10ms
+    is typical), each port in use is read once (IDR) and all pins
+    on the port are debounced together with a 2 bit vertical counter,
+    a pin has to be in a new state for 4 samples in a row before
+    it changes, cost is the same no matter how much the contacts
+    bounce (and no pin interrupts)
+
+    each debounced change is put into an event queue (a full queue
+    drops the new event), read in main code via event()
+
+    Debounce<8> keys{ PINS::LOWISON, PINS::PA0, PINS::PA1, PINS::PB4 };
+
+    (in a 5ms timer isr) keys.sample();
+
+    Debounce<8>::Event e;
+    while( keys.event(e) ){ if( e.press ) ... e.pin ... }
+
+    pins are set as inputs, pullup if LOWISON, pulldown if HIGHISON
+    any gpio port (A-F, arrays sized by PINS::PORTS), only ports with
+    pins in use are read
+=============================================================*/
+template<u8 Qsize_ = 16>
+class Debounce {
+
+//-------------|
+    public:
+//-------------|
+
+                struct Event { PINS::PIN pin; bool press; };
+
+//-------------|
+    private:
+//-------------|
+
+                SCA PORTS_{ PINS::PORTS }; //any pin/16 in range
+
+                struct Port {
+                    u16 mask;           //pins in use
+                    u16 state;          //debounced pin state (1=high)
+                    u16 cnt0, cnt1;     //vertical counter bits
+                    };
+
+                Port ports_[PORTS_]{};
+                u16 invert_;            //0xFFFF if LOWISON
+                u8 queue_[Qsize_];      //bit7=press, bit0-6=pin
+                volatile u8 qIn_{0}, qOut_{0};
+
+                II static GPIO_TypeDef&
+reg             (u32 port) { return *(GPIO_TypeDef*)(GPIOA_BASE + (GPIOB_BASE-GPIOA_BASE)*port); }
+
+                //isr only
+                auto
+put             (u8 v)
+                {
+                u8 n = qIn_ + 1; if( n >= Qsize_ ) n = 0;
+                if( n == qOut_ ) return; //full, drop
+                queue_[qIn_] = v;
+                qIn_ = n;
+                }
+
+//-------------|
+    public:
+//-------------|
+
+                template<typename... Ps>
+Debounce        (PINS::INVERT inv, Ps... pins)
+                : invert_( inv == PINS::LOWISON ? 0xFFFF : 0 )
+                {
+                const PINS::PIN list[]{ pins... };
+                for( auto pin : list ){
+                    GpioPin(pin).mode(PINS::INPUT).pull(inv == PINS::LOWISON ? PINS::PULLUP : PINS::PULLDOWN);
+                    ports_[pin/16].mask or_eq 1<<(pin%16);
+                    }
+                //start with current pin states, so no events at startup
+                for( auto port = 0u; port < PORTS_; port++ ){
+                    if( ports_[port].mask ) ports_[port].state = reg(port).IDR bitand ports_[port].mask;
+                    }
+                }
+
+                //call at a fixed rate
+                auto
+sample          ()
+                {
+                for( auto port = 0u; port < PORTS_; port++ ){
+                    auto& p = ports_[port];
+                    if( not p.mask ) continue;
+                    u16 delta = (reg(port).IDR bitand p.mask) xor p.state;
+                    p.cnt1 = (p.cnt1 xor p.cnt0) bitand delta;  //count up while different
+                    p.cnt0 = compl p.cnt0 bitand delta;         //reset when same
+                    u16 changed = delta bitand compl (p.cnt0 bitor p.cnt1); //counted to 4
+                    p.state xor_eq changed;
+                    u16 on = p.state xor invert_;
+                    while( changed ){
+                        auto n = ctz( changed );
+                        changed and_eq changed-1;
+                        put( port*16 + n + ((on bitand (1<<n)) ? 0x80 : 0) );
+                        }
+                    }
+                }
+
+                //get next event, false if none
+                auto
+event           (Event& e)
+                {
+                if( qIn_ == qOut_ ) return false;
+                u8 v = queue_[qOut_];
+                e = { PINS::PIN(v bitand 0x7F), bool(v bitand 0x80) };
+                u8 n = qOut_ + 1; if( n >= Qsize_ ) n = 0;
+                qOut_ = n;
+                return true;
+                }
+
+                //current debounced state of a pin
+                auto
+isOn            (PINS::PIN pin)
+                {
+                return ((ports_[pin/16].state xor invert_) bitand (1<<(pin%16))) != 0;
+                }
+
+};
@@ -0,0 +1,86 @@
+#pragma once //Dma.hpp
+
+#include "MyStm32.hpp"
+
+/*=============================================================
+    DmaCh - DMA1 channel 1-5, with its DMAMUX channel (0-4)
+    simple single block transfers, polled or with a
+    user function called from the channel interrupt
+
+    DmaCh dma{ 1 };
+    dma.start( DmaCh::MEM2PER bitor DmaCh::W32, &GPIOA->BSRR, buf, 16, Tim3.dmaUp );
+    while( dma.isBusy() ){}
+=============================================================*/
+struct DmaCh {
+
+//-------------|
+    public:
+//-------------|
+
+                enum //CCR bits
+CONFIG          {
+                PER2MEM = 0, MEM2PER = DMA_CCR_DIR,
+                CIRC = DMA_CCR_CIRC, MINC = DMA_CCR_MINC, PINC = DMA_CCR_PINC,
+                W8 = 0, W16 = DMA_CCR_PSIZE_0 bitor DMA_CCR_MSIZE_0,
+                W32 = DMA_CCR_PSIZE_1 bitor DMA_CCR_MSIZE_1,
+                PRIHIGH = DMA_CCR_PL_1, PRIVHIGH = DMA_CCR_PL
+                };
+
+//-------------|
+    private:
+//-------------|
+
+                DMA_Channel_TypeDef& reg_;
+                DMAMUX_Channel_TypeDef& mux_;
+                u8 ch_; //0-4
+
+                //flags for our channel (GIF,TCIF,HTIF,TEIF)
+                auto
+flags           () { return (DMA1->ISR>>(4*ch_)) bitand 15; }
+
+//-------------|
+    public:
+//-------------|
+
+DmaCh           (u8 ch) //1-5
+                : reg_( *(DMA_Channel_TypeDef*)(DMA1_Channel1_BASE + (DMA1_Channel2_BASE-DMA1_Channel1_BASE)*(ch-1)) ),
+                  mux_( DMAMUX1[ch-1] ),
+                  ch_( ch-1 )
+                {
+                RCC->AHBENR or_eq RCC_AHBENR_DMA1EN;
+                }
+
+                auto
+stop            ()
+                {
+                reg_.CCR and_eq compl DMA_CCR_EN;
+                DMA1->IFCR = 15<<(4*ch_); //clear all our flags
+                return *this;
+                }
+
+                //start a transfer- per (peripheral address), mem, count, dmamux request id
+                auto
+start           (u32 config, volatile void* per, const volatile void* mem, u16 n, u8 reqId)
+                {
+                stop();
+                mux_.CCR = reqId;
+                reg_.CPAR = (u32)per;
+                reg_.CMAR = (u32)mem;
+                reg_.CNDTR = n;
+                reg_.CCR = config bitor DMA_CCR_EN;
+                return *this;
+                }
+
+                //transfers remaining
+                auto
+remaining       () { return reg_.CNDTR; }
+
+                auto
+isDone          () { return flags() bitand DMA_ISR_TCIF1; }
+                auto
+isError         () { return flags() bitand DMA_ISR_TEIF1; }
+                //enabled and not complete (circular mode is always busy)
+                auto
+isBusy          () { return (reg_.CCR bitand DMA_CCR_EN) and not isDone() and not isError(); }
+
+};
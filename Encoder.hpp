@@ -1,6 +1,10 @@
 #pragma once // Encoder.hpp
 
 #include "MyStm32.hpp"
+#include "Exti.hpp"
+#include "Tim.hpp"
+#include "QuadTable.hpp"
+#include "SpeedCalc.hpp"
 
 /*-----------------------------------------------------------------------------
     Encoder
@@ -43,6 +47,14 @@
     lambda functions which cal be used to dispatch any calls needed to
     service that interrupt
 
+    or, let the Exti dispatcher handle the vectors (see Exti.hpp), where
+    each encoder pin line gets its own handler and no flag polling is
+    needed (do not also use the above irqFunction's)-
+
+        encoder1.extiAttach();
+        encoder2.extiAttach();
+        encoder3.extiAttach();
+
 -----------------------------------------------------------------------------*/
 class Encoder {
 
@@ -64,26 +76,28 @@ Encoder         (PINS::PIN pina, PINS::PIN pinb)
                 }
 
                 //read the current count (count remains unchanged)
-                //(absolute position, up to a point)
                 //0=no change, -val=CCW, +val=CW
                 auto
-count           ()
-                {
-                //count_ read is atomic on 32bit mcu, InterruptLock noe needed
-                return count_;
-                }
+count           () { return (i32)(count_ - base_); }
 
                 //read/consume the current count (count zeroed)
                 //0=no change, -val=CCW, +val=CW
+                //the isr only adds to count_ and the reader keeps its own
+                //watermark (base_), so no InterruptLock needed
                 auto
 read            ()
                 {
-                InterruptLock lock; //writing/clearing, so don't want to miss a step
-                auto ret = count_;
-                count_ = 0;
+                u32 c = count_; //single 32bit read is atomic
+                auto ret = (i32)(c - base_);
+                base_ = c;
                 return ret;
                 }
 
+                //the raw running count (wraps), for other readers using
+                //their own watermark- ReadDelta<u32> ui{ encoder1.raw() };
+                auto&
+raw             () { return count_; }
+
                 //reset count to 0
                 auto
 reset           () { read(); }
@@ -91,24 +105,42 @@ reset           () { read(); }
                 //public access
                 auto
 isr             ()
+                {
+                //check our pin is flagged
+                if( not (isIrqA_ ? pinA_.isFlag() : pinB_.isFlag()) ) return;
+                edge();
+                }
+
+                //use the Exti dispatcher for both pins instead of calling isr()
+                //(only the armed pin has its irq enabled, so either line is the
+                // edge we are waiting for, and the dispatcher already cleared the flag)
+                auto
+extiAttach      ()
+                {
+                auto f = [](void* p, Exti::EDGE){ static_cast<Encoder*>(p)->edge(); };
+                Exti::attach( pinA_.extiLine(), f, this );
+                Exti::attach( pinB_.extiLine(), f, this );
+                }
+
+//-------------|
+    private:
+//-------------|
+
+                //armed pin irq has fired (flag already cleared)
+                auto
+edge            () -> void
                 {
                 if( isIrqA_ ) { //A irq
-                    if( not pinA_.isFlag() ) return; //our pin is not flagged
                     B_ = pinB_.isOn(); //get state of other pin
-                    if( not A_ and not B_ and (count_ != COUNTMAX) ) count_++;
+                    if( not A_ and not B_ ) count_ = count_ + 1;
                     }
                 else { //B irq
-                    if( not pinB_.isFlag() ) return;
                     A_ = pinA_.isOn();
-                    if( not A_ and not B_ and (count_ != COUNTMIN) ) count_--;
+                    if( not A_ and not B_ ) count_ = count_ - 1;
                     }
                 irqSwap();
                 }
 
-//-------------|
-    private:
-//-------------|
-
                 //irqMode() will clear pin flag
                 auto
 irqSwap         () -> void
@@ -129,10 +161,8 @@ irqSwap         () -> void
                 GpioPin pinB_;
                 volatile bool A_{1},B_{1};  //pin state measured in opposite isr
                 volatile bool isIrqA_;      //1=a, 0=b
-                volatile i32 count_;        //encoder count
-                //set min/max limit values to match count_ type/size
-                SCA COUNTMIN{ (i32)0x80000000 };
-                SCA COUNTMAX{ (i32)0x7FFFFFFF };
+                volatile u32 count_{0};     //encoder count (isr only adds, wraps)
+                u32 base_{0};               //count at last read
 
 };
 
@@ -156,3 +186,435 @@ irqSwap         () -> void
 //         [](){ encoder1.isr(); }
 //     );
 // }
+
+
+/*-----------------------------------------------------------------------------
+    EncoderTim
+
+    hardware quadrature decoding using a timer in encoder mode (TIM1/2/3),
+    both edges of both pins are counted by the timer (4 counts per
+    quadrature cycle), so no cpu use per edge and no speed limit other
+    than the timer input filter
+
+    16bit timers are extended to 32bits in software from the signed 16bit
+    change in CNT (no direction bit needed, so a reversal before the irq
+    is serviced, or a dither across 0 that wraps twice, is not lost)- the
+    irq samples CNT on the wrap (update) and at 0x8000 (CC3 compare, no
+    pin used), so every half range of travel, and CNT is within 32767 of
+    the last sample when read (TIM2 is already 32bits, so no irq used)
+
+    same count()/read()/reset() use as Encoder (but in 4x counts)
+
+        inline EncoderTim encoder1{ Tim3_Enc_B4B5 }; //D12, D11
+
+    filter is the timer input filter value (0-15) for both inputs, see
+    ICxF in the reference manual (default 3 = 8 clocks at timer clock)
+-----------------------------------------------------------------------------*/
+
+class EncoderTim : RccTim {
+
+//-------------|
+    public:
+//-------------|
+
+EncoderTim      (timEncT t, u8 filter = 3)
+                : reg_( *t.tim.tim ), is32_( t.tim.tim == TIM2 )
+                {
+                instances_[ t.tim.tim == TIM1 ? 0 : t.tim.tim == TIM2 ? 1 : 2 ] = this;
+                GpioPin(t.pinA).mode(PINS::INPUT).pull(PINS::PULLUP).altFunc(t.altFuncA);
+                GpioPin(t.pinB).mode(PINS::INPUT).pull(PINS::PULLUP).altFunc(t.altFuncB);
+                RccTim::reset( t.tim.tim );
+                RccTim::enable( t.tim.tim );
+                //CC1S=01,CC2S=01 (TI1,TI2 inputs), ICxF filter
+                reg_.CCMR1 = (filter<<TIM_CCMR1_IC1F_Pos) bitor (filter<<TIM_CCMR1_IC2F_Pos) bitor
+                             TIM_CCMR1_CC1S_0 bitor TIM_CCMR1_CC2S_0;
+                reg_.SMCR = TIM_SMCR_SMS_0 bitor TIM_SMCR_SMS_1;    //encoder mode 3, both inputs both edges
+                reg_.ARR = is32_ ? 0xFFFFFFFF : 0xFFFF;
+                reg_.CR1 = TIM_CR1_URS;                             //only over/underflow generates update irq
+                if( not is32_ ){
+                    reg_.CCR3 = 0x8000;                             //CC3 frozen output (no pin), half range
+                    reg_.DIER = TIM_DIER_UIE bitor TIM_DIER_CC3IE;
+                    irqFunction( t.tim.irqn, isrAll );
+                    }
+                reg_.CR1 or_eq TIM_CR1_CEN;
+                }
+
+                //read the current count (count remains unchanged)
+                //0=no change, -val=CCW, +val=CW
+                auto
+count           () { return position() - base_; }
+
+                //read/consume the current count (count zeroed)
+                //(only the reader changes base_, so no irq lock needed)
+                auto
+read            ()
+                {
+                auto p = position();
+                auto ret = p - base_;
+                base_ = p;
+                return ret;
+                }
+
+                //reset count to 0
+                auto
+reset           () { read(); }
+
+                //32bit position, last sample plus the signed change in CNT since
+                //(isr only writes pos_, one word, reread if it changed while
+                //reading CNT, so no InterruptLock needed)
+                i32
+position        ()
+                {
+                if( is32_ ) return reg_.CNT;
+                i32 p; u16 c;
+                do{ p = pos_; c = reg_.CNT; } while( p != pos_ );
+                return p + (i16)(c - (u16)p);
+                }
+
+//-------------|
+    private:
+//-------------|
+
+                //wrap or half range, sample CNT (lower 16bits of pos_ always
+                //equal CNT as sampled, so the change is signed 16bits)
+                auto
+isr             ()
+                {
+                reg_.SR = compl (TIM_SR_UIF bitor TIM_SR_CC3IF); //rc_w0
+                i32 p = pos_;
+                pos_ = p + (i16)((u16)reg_.CNT - (u16)p);
+                }
+
+                static void
+isrAll          ()
+                {
+                auto n = irqActive();
+                auto ptr = n == TIM1_BRK_UP_TRG_COM_IRQn ? instances_[0] :
+                           n == TIM2_IRQn ? instances_[1] : instances_[2];
+                ptr->isr();
+                }
+
+                TIM_TypeDef& reg_;
+                bool is32_;
+                volatile i32 pos_{0};       //position at last isr sample (16bit timers)
+                i32 base_{0};               //position at last read
+                static inline EncoderTim* instances_[3]; //for isr use, TIM1,TIM2,TIM3
+
+};
+
+
+/*-----------------------------------------------------------------------------
+    EncoderSpeed
+
+    encoder velocity/acceleration using the M/T method- edges are timestamped
+    with a free running 1MHz timer (edge() called from the encoder isr), and
+    at a periodic tick() (some timer isr, 1-10ms typical) velocity is the
+    edges counted divided by the time between the last edge of the previous
+    tick and the last edge of this tick- so is count/window at high speed and
+    edge period timing at low speed, with no switch-over needed
+
+    if no edges in a tick, the velocity can be no more than 1 count since the
+    last edge, so decays toward 0 (and is 0 after timeoutUs)
+
+    results are fixed point Q24.8 (counts/sec, counts/sec^2), published
+    with a sequence count so snapshot() never needs to disable interrupts
+    and is O(1) in main code
+
+        inline EncoderSpeed speed1{ Tim2 }; //TIM2 is 32bits, best choice
+        inline EncoderQuad encoder1{ PB4, PB5 };
+        encoder1.speed( speed1 );
+        (in a 5ms timer isr) speed1.tick();
+        auto s = speed1.snapshot(); //s.velocity/256 = counts/sec
+
+    with a 16bit timer, edge periods longer than 65ms read as no edges
+    (so use timeoutUs < 65000)
+-----------------------------------------------------------------------------*/
+class EncoderSpeed {
+
+//-------------|
+    public:
+//-------------|
+
+                struct Snapshot { i32 velocity, acceleration; u32 time; };
+
+EncoderSpeed    (timT t, u32 timeoutUs = 500000)
+                : tim_( t ),
+                  calc_( tim_.is32 ? 0xFFFFFFFF : 0xFFFF, timeoutUs, tim_.freeRun( 1000000 ).count() )
+                {
+                tEdge_ = now();
+                }
+
+                //1us timestamp
+                auto
+now             () -> u32 { return tim_.count(); }
+
+                //encoder isr, each counted step (+/-1)
+                auto
+edge            (i8 dir)
+                {
+                tEdge_ = now();
+                edges_ = edges_ + dir;
+                }
+
+                //periodic (isr)
+                auto
+tick            ()
+                {
+                i32 e; u32 t;
+                do{ e = edges_; t = tEdge_; } while( e != edges_ ); //edge() may be higher priority
+                auto tnow = now();
+                auto r = calc_.update( e, t, tnow ); //see SpeedCalc.hpp
+                seq_ = seq_ + 1;    //odd = update in progress
+                vel_ = r.velocity;
+                acc_ = r.acceleration;
+                time_ = tnow;
+                seq_ = seq_ + 1;
+                }
+
+                //latest results, reread if a tick() happened while reading
+                Snapshot
+snapshot        ()
+                {
+                Snapshot s; u32 q;
+                do{
+                    q = seq_;
+                    s = { vel_, acc_, time_ };
+                    } while( (q bitand 1) or q != seq_ );
+                return s;
+                }
+
+//-------------|
+    private:
+//-------------|
+
+                Tim tim_;
+                SpeedCalc calc_;            //tick() only
+                volatile u32 tEdge_;        //last edge time (isr)
+                volatile i32 edges_{0};     //edge count (isr)
+                volatile u32 seq_{0};       //published results
+                volatile i32 vel_{0}, acc_{0};
+                volatile u32 time_{0};
+
+};
+
+
+/*-----------------------------------------------------------------------------
+    EncoderQuad
+
+    4x exti decoder- both pins irq on both edges, and on every edge both
+    pins are read and the previous/current state is looked up in QuadTable,
+    so every edge is counted (4 counts per quadrature cycle), bounce cancels
+    out, and a missed state is counted as an error instead of a step
+
+    the same exti unique pin number limitation as Encoder applies
+
+        inline EncoderQuad encoder1{ PB4, PB5 };
+        encoder1.extiAttach(); //or call encoder1.isr() from your own vector function
+-----------------------------------------------------------------------------*/
+class EncoderQuad {
+
+//-------------|
+    public:
+//-------------|
+
+EncoderQuad     (PINS::PIN pina, PINS::PIN pinb)
+                : pinA_( GpioPin(pina)
+                        .mode(PINS::INPUT)
+                        .pull(PINS::PULLUP)
+                        .irqBothEdges() ),
+                  pinB_( GpioPin(pinb)
+                        .mode(PINS::INPUT)
+                        .pull(PINS::PULLUP)
+                        .irqBothEdges() )
+                {
+                state_ = pins();
+                pinA_.irqOn();
+                pinB_.irqOn();
+                }
+
+                //read the current count (count remains unchanged)
+                //0=no change, -val=CCW, +val=CW
+                auto
+count           () { return (i32)(count_ - base_); }
+
+                //read/consume the current count (count zeroed)
+                //(only the reader changes base_, so no irq lock needed)
+                auto
+read            ()
+                {
+                u32 c = count_;
+                auto ret = (i32)(c - base_);
+                base_ = c;
+                return ret;
+                }
+
+                //reset count to 0
+                auto
+reset           () { read(); }
+
+                //the raw running count (wraps), for other readers
+                auto&
+raw             () { return count_; }
+
+                //missed states (both pins changed between edges)
+                auto
+errors          () { return errors_; }
+
+                //public access, either pin flagged
+                auto
+isr             ()
+                {
+                //get both so the 'or' does not leave the second untouched if set
+                bool a = pinA_.isFlag(), b = pinB_.isFlag();
+                if( a or b ) edge();
+                }
+
+                //timestamp each step for velocity estimation
+                auto
+speed           (EncoderSpeed& s) { speed_ = &s; }
+
+                //use the Exti dispatcher for both pins instead of calling isr()
+                auto
+extiAttach      ()
+                {
+                auto f = [](void* p, Exti::EDGE){ static_cast<EncoderQuad*>(p)->edge(); };
+                Exti::attach( pinA_.extiLine(), f, this );
+                Exti::attach( pinB_.extiLine(), f, this );
+                }
+
+//-------------|
+    private:
+//-------------|
+
+                auto
+pins            () -> u8 { return (pinA_.isOn() ? 2 : 0) bitor (pinB_.isOn() ? 1 : 0); }
+
+                auto
+edge            () -> void
+                {
+                u8 s = pins();
+                auto v = QuadTable::tbl[(state_<<2) bitor s];
+                state_ = s;
+                if( v == QuadTable::ERR ) errors_ = errors_ + 1;
+                else if( v ){
+                    count_ = count_ + v;
+                    if( speed_ ) speed_->edge( v );
+                    }
+                }
+
+                GpioPin pinA_;
+                GpioPin pinB_;
+                volatile u8 state_;         //last AB state
+                volatile u32 count_{0};     //encoder count (isr only adds, wraps)
+                volatile u32 errors_{0};
+                u32 base_{0};               //count at last read
+                EncoderSpeed* speed_{nullptr};
+
+};
+
+
+/*-----------------------------------------------------------------------------
+    EncoderScan
+
+    polled decoding of many encoders- sample() is called at a fixed rate
+    from a timer isr, each port in use is read once (IDR), and each encoder
+    state is decoded with QuadTable (4x counts)
+
+    no exti used, so no unique pin number limitation, any number of encoders
+    (panel of knobs), and contact bounce is filtered by the sample rate- the
+    rate needs to be faster than the fastest expected edge rate (1-2kHz is
+    enough for hand turned knobs)
+
+        inline EncoderScan<3> knobs{ PB4, PB5, PA0, PA1, PA4, PA5 }; //pin A,B pairs
+        (in a 1ms timer isr) knobs.sample();
+        auto c = knobs.read(0);
+-----------------------------------------------------------------------------*/
+template<u8 N_>
+class EncoderScan {
+
+//-------------|
+    private:
+//-------------|
+
+                SCA PORTS_{ PINS::PORTS }; //any pin/16 in range
+
+                struct Enc {
+                    u8 a, b;            //port*16+pin
+                    u8 state;           //last AB state
+                    volatile u32 count; //isr only adds, wraps
+                    u32 base;           //count at last read
+                    };
+
+                Enc enc_[N_];
+                u8 ports_{0};           //bitmask of ports in use
+                volatile u32 errors_{0};
+
+                II static GPIO_TypeDef&
+reg             (u32 port) { return *(GPIO_TypeDef*)(GPIOA_BASE + (GPIOB_BASE-GPIOA_BASE)*port); }
+
+                //current AB state from port values
+                static auto
+ab              (const u16* idr, const Enc& e) -> u8
+                {
+                return ((idr[e.a/16]>>(e.a%16) bitand 1)<<1) bitor (idr[e.b/16]>>(e.b%16) bitand 1);
+                }
+
+//-------------|
+    public:
+//-------------|
+
+                template<typename... Ps>
+EncoderScan     (Ps... pins)
+                {
+                static_assert( sizeof...(Ps) == 2*N_, "EncoderScan- need pin A,B for each encoder" );
+                const PINS::PIN list[]{ pins... };
+                for( auto i = 0; i < N_; i++ ){
+                    auto& e = enc_[i];
+                    e = { u8(list[2*i]), u8(list[2*i+1]), 0, 0, 0 };
+                    GpioPin(list[2*i]).mode(PINS::INPUT).pull(PINS::PULLUP);
+                    GpioPin(list[2*i+1]).mode(PINS::INPUT).pull(PINS::PULLUP);
+                    ports_ or_eq (1<<(e.a/16)) bitor (1<<(e.b/16));
+                    }
+                u16 idr[PORTS_]{};
+                for( auto p = 0u; p < PORTS_; p++ ) if( ports_ bitand (1<<p) ) idr[p] = reg(p).IDR;
+                for( auto& e : enc_ ) e.state = ab( idr, e );
+                }
+
+                //call at a fixed rate
+                auto
+sample          ()
+                {
+                u16 idr[PORTS_];
+                for( auto p = 0u; p < PORTS_; p++ ) if( ports_ bitand (1<<p) ) idr[p] = reg(p).IDR;
+                for( auto& e : enc_ ){
+                    u8 s = ab( idr, e );
+                    if( s == e.state ) continue;
+                    auto v = QuadTable::tbl[(e.state<<2) bitor s];
+                    e.state = s;
+                    if( v == QuadTable::ERR ) errors_ = errors_ + 1;
+                    else e.count = e.count + v;
+                    }
+                }
+
+                //read the current count (count remains unchanged)
+                auto
+count           (u8 i) { return (i32)(enc_[i].count - enc_[i].base); }
+
+                //read/consume the current count (count zeroed)
+                auto
+read            (u8 i)
+                {
+                u32 c = enc_[i].count;
+                auto ret = (i32)(c - enc_[i].base);
+                enc_[i].base = c;
+                return ret;
+                }
+
+                auto
+reset           (u8 i) { read(i); }
+
+                //missed states (all encoders), sample rate too slow if this increases
+                auto
+errors          () { return errors_; }
+
+};
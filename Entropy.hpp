@@ -0,0 +1,164 @@
+#pragma once //Entropy.hpp
+
+#include "MyStm32.hpp"
+
+//linker symbols, reset count is the second to last word (see startup.cpp)
+extern u32 _sramdebug[], _eramdebug[];
+
+/*=============================================================
+    Entropy - seed values from hardware noise
+
+    sources-
+        device unique id (96bits)- differs across units
+        reset counter in .ramdebug- differs across warm resets
+        adc lsb noise- temperature sensor and vrefint, fastest
+            sample time, 32 conversions of each
+        lsi vs hsi jitter- cpu cycles (systick) counted for each
+            lptim tick clocked from lsi, 32 ticks
+
+    each sample is mixed into a murmur3 style hash, and the hash
+    is finalized when read
+
+    call Entropy::seed() from preinit() to seed the shared Rng in
+    UTIL (used by random16/32/64 and shuffle) before any constructors
+    run (startup has already applied the board pins)- the adc and
+    LPTIM1 are reset when done, and systick is left as found (Systick
+    time base, or off), so they are free to use later
+
+    void preinit(){ Entropy::seed(); }
+
+    Rng myRng{ Entropy::get() }; //for your own Rng objects
+=============================================================*/
+struct Entropy {
+
+//-------------|
+    private:
+//-------------|
+
+                static u32
+rotl            (u32 v, int n) { return (v<<n) bitor (v>>(32-n)); }
+
+                static u32
+mix             (u32 h, u32 v)
+                {
+                v *= 0xCC9E2D51;
+                v = rotl( v, 15 ) * 0x1B873593;
+                h xor_eq v;
+                return rotl( h, 13 ) * 5 + 0xE6546B64;
+                }
+
+                static u32
+finalize        (u32 h)
+                {
+                h xor_eq h>>16; h *= 0x85EBCA6B;
+                h xor_eq h>>13; h *= 0xC2B2AE35;
+                return h xor (h>>16);
+                }
+
+                static u32
+deviceId        (u32 h)
+                {
+                auto uid = (volatile u32*)UID_BASE;
+                for( auto i = 0; i < 3; i++ ) h = mix( h, uid[i] );
+                return h;
+                }
+
+                static u32
+resetCount      (u32 h)
+                {
+                u32 n = _eramdebug - _sramdebug;    //index from start, not [-2] on the end
+                return n >= 2 ? mix( h, _sramdebug[n-2] ) : h;
+                }
+
+                //temperature sensor (ch12), vrefint (ch13), adc clock is pclk/2
+                static u32
+adcNoise        (u32 h)
+                {
+                RCC->APBENR2 or_eq RCC_APBENR2_ADCEN;
+                ADC1->CFGR2 = ADC_CFGR2_CKMODE_0;               //pclk/2
+                ADC1->CR = ADC_CR_ADVREGEN;
+                delayUS( 20 );                                  //regulator startup
+                ADC1_COMMON->CCR = ADC_CCR_TSEN bitor ADC_CCR_VREFEN;
+                ADC1->SMPR = 0;                                 //1.5 cycles, noisiest
+                ADC1->ISR = ADC_ISR_ADRDY;
+                ADC1->CR or_eq ADC_CR_ADEN;
+                while( not (ADC1->ISR bitand ADC_ISR_ADRDY) ){}
+                static constexpr u32 chans[]{ ADC_CHSELR_CHSEL12, ADC_CHSELR_CHSEL13 };
+                for( auto ch : chans ){
+                    ADC1->CHSELR = ch;
+                    while( not (ADC1->ISR bitand ADC_ISR_CCRDY) ){}
+                    ADC1->ISR = ADC_ISR_CCRDY;
+                    for( auto i = 0; i < 32; i++ ){
+                        ADC1->CR or_eq ADC_CR_ADSTART;
+                        while( not (ADC1->ISR bitand ADC_ISR_EOC) ){}
+                        h = mix( h, ADC1->DR );                 //read clears EOC
+                        }
+                    }
+                RCC->APBRSTR2 or_eq RCC_APBRSTR2_ADCRST;        //back to reset state
+                RCC->APBRSTR2 and_eq compl RCC_APBRSTR2_ADCRST;
+                RCC->APBENR2 and_eq compl RCC_APBENR2_ADCEN;
+                return h;
+                }
+
+                //cpu cycles for each lsi tick, lsi is enabled if needed (and
+                //turned off again if it was off), LPTIM1 is used
+                static u32
+clockJitter     (u32 h)
+                {
+                auto lsiWasOn = RCC->CSR bitand RCC_CSR_LSION;
+                auto ccipr = RCC->CCIPR;
+                RCC->CSR or_eq RCC_CSR_LSION;
+                while( not (RCC->CSR bitand RCC_CSR_LSIRDY) ){}
+                RCC->CCIPR = (ccipr bitand compl RCC_CCIPR_LPTIM1SEL) bitor RCC_CCIPR_LPTIM1SEL_0; //lsi
+                RCC->APBENR1 or_eq RCC_APBENR1_LPTIM1EN;
+                LPTIM1->CR = LPTIM_CR_ENABLE;
+                LPTIM1->ARR = 0xFFFF;
+                LPTIM1->CR or_eq LPTIM_CR_CNTSTRT;
+                auto running = Systick::isOn(); //else free run systick while here
+                if( not running ){
+                    SysTick->LOAD = 0xFFFFFF;
+                    SysTick->VAL = 0;
+                    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk bitor SysTick_CTRL_ENABLE_Msk;
+                    }
+                u32 reload = SysTick->LOAD + 1;
+                auto cnt = []{ u32 v; while( v = LPTIM1->CNT, v != LPTIM1->CNT ){} return v; };
+                auto c = cnt();
+                u32 t = SysTick->VAL;
+                for( auto i = 0; i < 32; i++ ){
+                    while( cnt() == c ){}
+                    c = cnt();
+                    u32 now = SysTick->VAL;
+                    h = mix( h, t >= now ? t - now : t + reload - now ); //counts down
+                    t = now;
+                    }
+                if( not running ) SysTick->CTRL = 0;
+                RCC->APBRSTR1 or_eq RCC_APBRSTR1_LPTIM1RST;
+                RCC->APBRSTR1 and_eq compl RCC_APBRSTR1_LPTIM1RST;
+                RCC->APBENR1 and_eq compl RCC_APBENR1_LPTIM1EN;
+                RCC->CCIPR = ccipr;
+                if( not lsiWasOn ) RCC->CSR and_eq compl RCC_CSR_LSION;
+                return h;
+                }
+
+//-------------|
+    public:
+//-------------|
+
+                //collect from all sources (~1ms), can be called any time
+                //the adc and LPTIM1 are not in use
+                static u32
+get             ()
+                {
+                u32 h = 0x811C9DC5;
+                h = deviceId( h );
+                h = resetCount( h );
+                h = adcNoise( h );
+                h = clockJitter( h );
+                return finalize( h );
+                }
+
+                //seed the shared Rng
+                static void
+seed            () { rng.seed( get() ); }
+
+};
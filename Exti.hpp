@@ -0,0 +1,98 @@
+#pragma once //Exti.hpp
+
+#include "MyStm32.hpp"
+
+/*=============================================================
+    Exti - exti line dispatcher
+
+    the exti vectors are shared by more than one line (EXTI4_15_IRQn
+    has 12), so instead of each device checking its own flag, a
+    single isr reads the pending flags once, clears them, then calls
+    a handler for each line that fired (lowest line first, all rising
+    then all falling)- isr cost depends on the lines that fired, not
+    on the number of devices using the vector
+
+    only lines enabled in the exti mask register are dispatched
+
+    a handler is a plain function (or non-capturing lambda) which
+    gets an object pointer (the one supplied when attached, can be
+    used to get back to a class instance) and the edge
+
+    Exti::attach( 5, [](void* p, Exti::EDGE e){ ... }, &obj );
+
+    attach() puts the dispatcher isr in the vector for the line, so
+    do not also set your own function for the same vector
+=============================================================*/
+struct Exti {
+
+//-------------|
+    public:
+//-------------|
+
+                enum
+EDGE            { FALLING, RISING };
+
+                using handlerT = void(*)(void*, EDGE);
+
+//-------------|
+    private:
+//-------------|
+
+                struct Handler { handlerT func; void* obj; };
+
+                static inline Handler handlers_[16];
+
+                static void
+dispatch        (u32 bm, EDGE e)
+                {
+                while( bm ){
+                    auto& h = handlers_[ctz(bm)];
+                    bm and_eq bm-1; //clear lowest bit
+                    if( h.func ) h.func( h.obj, e );
+                    }
+                }
+
+                //static, so can put this function address in the vector table
+                //(same function in all 3 exti vectors)
+                static void
+isr             ()
+                {
+                auto im = EXTI->IMR1 bitand 0xFFFF;
+                auto r = EXTI->RPR1 bitand im, f = EXTI->FPR1 bitand im;
+                EXTI->RPR1 = r; //clear all at once
+                EXTI->FPR1 = f;
+                dispatch( r, RISING );
+                dispatch( f, FALLING );
+                }
+
+//-------------|
+    public:
+//-------------|
+
+                //which IRQn_Type a line belongs to
+                SCA
+irqN            (u8 line)
+                {
+                return line <= 1 ? EXTI0_1_IRQn :
+                       line <= 3 ? EXTI2_3_IRQn :
+                       EXTI4_15_IRQn;
+                }
+
+                //line 0-15 (the pin number), pin irq setup is still done
+                //via the pin (GpioPin irqOn, irqRising, etc.)
+                static void
+attach          (u8 line, handlerT f, void* obj = nullptr)
+                {
+                { InterruptLock lock; handlers_[line] = { f, obj }; }
+                irqFunction( irqN(line), isr );
+                }
+
+                //vector left in place (other lines may be using it)
+                static void
+detach          (u8 line)
+                {
+                InterruptLock lock;
+                handlers_[line] = { nullptr, nullptr };
+                }
+
+};
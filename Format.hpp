@@ -6,6 +6,7 @@
 //==================================================================
 // FMT namespace
 //      Print class
+//      TeePrint class
 //      PrintNull class
 //      operator<< code
 //==================================================================
@@ -26,11 +27,16 @@ enum FMT_RESET      { reset };                                  //all options re
 enum FMT_COUNTCLR   { countclr };                               //clear char out count
 enum FMT_ENDL2      { endl2 };                                  //endl x2
 
+template<int N> class TeePrint; //forward declaration, friend of Print
+
 //==================================================================
 // FMT::Print class
 //==================================================================
 class Print {
 
+        //TeePrint needs access to the private write functions of its sinks
+        template<int N> friend class TeePrint;
+
         //constant values
         enum { PRECISION_MAX = 9 }; //max float precision, limited to 9 by use of 32bit integers in calculations
 
@@ -43,10 +49,11 @@ class Print {
         auto&
 print   (const char* str)
         {
-        auto pad = width_ - (int)__builtin_strlen(str); //padding size (will be used if >0)
+        auto len = (int)__builtin_strlen(str);          //string length
+        auto pad = width_ - len;                        //padding size (will be used if >0)
         width_ = 0;                                     //always reset after use
         isNeg_ = false;                                 //clear for the other 2 functions (since they both will end up here)
-        auto strwr = [&]{ while( *str ) write_( *str++ ); }; //function to write the string
+        auto strwr = [&]{ write_( str, len ); };        //function to write the string (as a span)
         if( pad <= 0 or just_ == left ) strwr();        //print str first
         if( pad > 0 ){                                  //need to deal with padding
             while( pad-- > 0 ) write_( fill_ );         //print any needed padding
@@ -186,10 +193,18 @@ print   (FMT_RESET e)
         //(if any write fails as defined by the parent class (returns false), the failure
         // is only reflected in the count and not used any further)
         void write_  (const char c)     { if( write(c) ) count_++; }
+        void write_  (const char* str, int n) { count_ += write( str, n ); }
 
         virtual
         bool write  (const char) = 0; //parent class creates this function
 
+        //write a span of chars, return number of chars written (successfully)
+        //default is one char at a time via write(char), a parent class can
+        //override if it has a better way to deal with a span
+        virtual
+        int  write  (const char* str, int n)
+                    { auto cnt = 0; while( n-- > 0 ) if( write(*str++) ) cnt++; return cnt; }
+
         char            nl_[3]      { '\n', '\0', '\0' };
         FMT_JUSTIFY     just_       { left };
         FMT_SHOWBASE    showbase_   { noshowbase };
@@ -205,6 +220,71 @@ print   (FMT_RESET e)
 
 };
 
+//==================================================================
+// FMT::TeePrint class
+//      format once, then write the resulting chars (as spans when
+//      possible) to up to N other Print instances (sinks)
+//      each sink has an enable bit (all enabled by default), so
+//      formatting cost is the same no matter how many sinks are in use
+//      (the sink's own format options are not used, only its write)
+//
+//      TeePrint<2> log{ uart, uart1 };
+//      log << "both" << endl;
+//      log.off(1) << "uart only" << endl;
+//      log.enable(0b10) << "uart1 only" << endl;
+//==================================================================
+template<int N>
+class TeePrint : public Print {
+
+        static_assert( N > 0 and N <= 32, "TeePrint- sink count 1-32" );
+
+//----------
+  public:
+//----------
+
+        template<typename... Ps>
+        TeePrint    (Ps&... ps) : sinks_{ &ps... }
+                    { static_assert( sizeof...(Ps) <= N, "TeePrint- too many sinks" ); }
+
+        //sink enables, by index or all at once as a bitmask (bit0 = sink[0])
+        auto& on        (int i)             { enables_ or_eq (1u<<i); return *this; }
+        auto& off       (int i)             { enables_ and_eq compl (1u<<i); return *this; }
+        auto& enable    (u32 bm)            { enables_ = bm; return *this; }
+        bool  isOn      (int i)             { return enables_ bitand (1u<<i); }
+
+        //set a sink (replace, or add to an unused slot)
+        auto& sink      (int i, Print& p)   { sinks_[i] = &p; return *this; }
+
+//----------
+  private:
+//----------
+
+        //each enabled sink gets the same char/span, success if any sink wrote it all
+        bool write  (const char c) override
+                    {
+                    auto ok = false;
+                    for( auto i = 0; i < N; i++ ){
+                        if( sinks_[i] and isOn(i) and sinks_[i]->write(c) ) ok = true;
+                        }
+                    return ok;
+                    }
+
+        int  write  (const char* str, int n) override
+                    {
+                    auto cnt = 0;
+                    for( auto i = 0; i < N; i++ ){
+                        if( not sinks_[i] or not isOn(i) ) continue;
+                        auto c = sinks_[i]->write( str, n );
+                        if( c > cnt ) cnt = c;
+                        }
+                    return cnt;
+                    }
+
+        Print*          sinks_[N]   {};
+        u32             enables_    { 0xFFFFFFFF };
+
+};
+
 //==================================================================
 // FMT::PrintNull class (no  output, optimizes away all uses)
 //==================================================================
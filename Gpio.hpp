@@ -224,6 +224,10 @@ irqN            ()
                        EXTI4_15_IRQn;
                 }
 
+                //exti line is the pin number (same form as GpioPinT)
+                II constexpr auto
+extiLine        () const { return pin_; }
+
 
 // read
 
@@ -284,3 +288,403 @@ deinit          ()
 
 
 
+/*--------------------------------------------------------------
+    GpioPinT class template
+
+    same functions as GpioPin, but the pin is a template argument
+    so port address, pin mask and exti line are all compile time
+    constants- no ram used, and high()/low()/etc. end up as a
+    single store to a literal address
+
+    GpioPinT<PINS::PC6> led{ GpioPinT<PINS::PC6>().mode(PINS::OUTPUT).off() };
+    led.on();
+
+    (all functions are const, so a constexpr instance can also
+     be used- static constexpr GpioPinT<PINS::PC6> led{ false };)
+--------------------------------------------------------------*/
+template<PINS::PIN Pin_, PINS::INVERT Inv_ = PINS::HIGHISON>
+struct GpioPinT {
+
+//-------------|
+    private:
+//-------------|
+
+                SCA port_       { Pin_/16 };                    //port number(letter)
+                SCA pin_        { Pin_%16 };                    //0-15
+                SCA pinmask_    { (u16)(1<<pin_) };             //for bsr/bsrr
+                SCA invert_     { Inv_ };                       //so can do on/off
+                SCA base_       { GPIOA_BASE + (GPIOB_BASE-GPIOA_BASE)*port_ };
+
+                II static GPIO_TypeDef&
+reg             () { return *(GPIO_TypeDef*)base_; }
+
+//-------------|
+    public:
+//-------------|
+
+                SCA pin         { Pin_ };
+
+                //no init, rcc clock enabled by default unless not wanted
+                II constexpr
+GpioPinT        (bool clken = true) { if( clken ) enable(); }
+
+                II auto
+enable          () const { RCC->IOPENR or_eq (1<<port_); return *this; }
+
+// properties
+
+                II auto
+lock            () const
+                {
+                u32 vL = (1<<16) bitor pinmask_;
+                reg().LCKR = vL;
+                reg().LCKR = pinmask_;
+                reg().LCKR = vL;
+                (void)reg().LCKR; //read required to complete sequence
+                return *this;
+                }
+
+                II auto
+mode            (PINS::MODE e) const
+                {
+                SCA bp{ 2u*pin_ }, bmclr{ compl (3u<<bp) };
+                reg().MODER = (reg().MODER bitand bmclr) bitor (e<<bp);
+                return *this;
+                }
+
+                II auto
+outType         (PINS::OTYPE e) const
+                {
+                if( e == PINS::ODRAIN ) reg().OTYPER or_eq pinmask_;
+                else reg().OTYPER and_eq compl pinmask_;
+                return *this;
+                }
+
+                II auto
+pull            (PINS::PULL e) const
+                {
+                SCA bp{ 2u*pin_ }, bmclr{ compl (3u<<bp) };
+                reg().PUPDR = (reg().PUPDR bitand bmclr) bitor (e<<bp);
+                return *this;
+                }
+
+                II auto
+speed           (PINS::SPEED e) const
+                {
+                SCA bp{ 2u*pin_ }, bmclr{ compl (3u<<bp) };
+                reg().OSPEEDR = (reg().OSPEEDR bitand bmclr) bitor (e<<bp);
+                return *this;
+                }
+
+                II auto
+altFunc         (PINS::ALTFUNC e) const
+                {
+                auto& r = reg().AFR[pin_>7 ? 1 : 0];
+                SCA bp{ 4u*(pin_ bitand 7) }, bmclr{ compl (15u<<bp) };
+                r = (r bitand bmclr) bitor (e<<bp);
+                return mode( PINS::ALTERNATE );
+                }
+
+// irq
+
+                //get rising flag, clear if set
+                II bool
+isFlagRise      () const
+                {
+                auto bm = EXTI->RPR1 bitand pinmask_;
+                EXTI->RPR1 = bm;
+                return bm;
+                }
+
+                //get falling flag, clear if set
+                II bool
+isFlagFall      () const
+                {
+                auto bm = EXTI->FPR1 bitand pinmask_;
+                EXTI->FPR1 = bm;
+                return bm;
+                }
+
+                //get any flag, clear if set
+                II bool
+isFlag          () const
+                { //get both so the 'or' does not leave the second untouched if set
+                bool r = isFlagRise(), f = isFlagFall();
+                return r or f;
+                }
+
+                II auto
+irqOff          () const
+                {
+                EXTI->IMR1 and_eq compl pinmask_;
+                return *this;
+                }
+
+                II auto
+irqOn           () const
+                {
+                RCC->APBENR2 or_eq RCC_APBENR2_SYSCFGEN; //so can read EXTI_LINEx
+                //set our port to use this pin irq
+                auto& r = EXTI->EXTICR[pin_/4];
+                SCA bp{ (pin_ bitand 3)*8u /*0,8,16,24*/ }, bmclr{ compl (0xFFu<<bp) };
+                r = (r bitand bmclr) bitor (port_<<bp);
+                isFlag(); //clear flags
+                EXTI->IMR1 or_eq pinmask_;
+                return *this;
+                }
+
+                II auto
+irqNoEdges      () const
+                {
+                EXTI->FTSR1 and_eq compl pinmask_;
+                EXTI->RTSR1 and_eq compl pinmask_;
+                return *this;
+                }
+
+                II auto
+irqRising       () const
+                {
+                EXTI->FTSR1 and_eq compl pinmask_;
+                EXTI->RTSR1 or_eq pinmask_;
+                return *this;
+                }
+
+                II auto
+irqFalling      () const
+                {
+                EXTI->RTSR1 and_eq compl pinmask_;
+                EXTI->FTSR1 or_eq pinmask_;
+                return *this;
+                }
+
+                II auto
+irqBothEdges    () const
+                {
+                EXTI->FTSR1 or_eq pinmask_;
+                EXTI->RTSR1 or_eq pinmask_;
+                return *this;
+                }
+
+                //exti line is the pin number (same form as GpioPin)
+                SCA
+extiLine        () { return pin_; }
+
+                //which IRQn_Type we belong to
+                SCA
+irqN            ()
+                {
+                return pin_ <= 1 ? EXTI0_1_IRQn :
+                       pin_ <= 3 ? EXTI2_3_IRQn :
+                       EXTI4_15_IRQn;
+                }
+
+// read
+
+                II auto
+pinVal          () const { return reg().IDR bitand pinmask_; }
+                II auto
+latVal          () const { return reg().ODR bitand pinmask_; }
+
+                II bool
+isHigh          () const { return pinVal(); }
+                II bool
+isLow           () const { return not isHigh(); }
+                II bool
+isOn            () const { return invert_ == PINS::LOWISON ? isLow() : isHigh(); }
+                II bool
+isOff           () const { return not isOn(); }
+
+// write
+
+                II auto
+high            () const { reg().BSRR = pinmask_; return *this; }
+                II auto
+low             () const { reg().BRR = pinmask_; return *this; }
+                II auto
+on              () const { return invert_ == PINS::LOWISON ? low() : high(); }
+                II auto
+off             () const { return invert_ == PINS::LOWISON ? high() : low(); }
+                II auto
+on              (bool tf) const { return tf ? on() : off(); }
+                II auto
+toggle          () const { return latVal() ? low() : high(); }
+                II auto
+pulseHL         () const { high(); return low(); }
+                II auto
+pulseLH         () const { low(); return high(); }
+                II auto
+pulse           () const { return latVal() ? pulseLH() : pulseHL(); }
+
+                //back to reset state- if reconfiguring pin from an unknown state
+                II auto
+deinit          () const
+                {
+                mode(PINS::ANALOG).outType(PINS::PUSHPULL).altFunc(PINS::AF0)
+                    .speed(PINS::SPEED0).pull(PINS::NOPULL).low();
+                //sw pins have a different reset state
+                if constexpr( Pin_ == PINS::SWCLK ) pull( PINS::PULLDOWN ).mode( PINS::ALTERNATE );
+                if constexpr( Pin_ == PINS::SWDIO ) pull( PINS::PULLUP ).speed( PINS::SPEED3 ).mode( PINS::ALTERNATE );
+                return *this;
+                }
+
+};
+
+/*--------------------------------------------------------------
+    GpioBus class template
+
+    a group of pins on the same port treated as an N bit value,
+    bit0 of the value is the first pin listed
+
+    a write is a single BSRR store (all pins change at the same
+    time), a read is a single IDR read- the bit reordering is done
+    with compile time tables (or just a shift if the pins are in
+    order and contiguous)
+
+    GpioBus<PINS::PA0,PINS::PA1,PINS::PA4,PINS::PA5> leds;
+    leds.mode(PINS::OUTPUT).write(0b1010);
+    auto v = leds.read();
+--------------------------------------------------------------*/
+template<PINS::PIN... Pins_>
+struct GpioBus {
+
+//-------------|
+    private:
+//-------------|
+
+                static constexpr PINS::PIN pins_[]{ Pins_... };
+                SCA N_          { sizeof...(Pins_) };
+                SCA port_       { pins_[0]/16 };
+                SCA base_       { GPIOA_BASE + (GPIOB_BASE-GPIOA_BASE)*port_ };
+
+                static_assert( N_ <= 16, "GpioBus- 16 pins max" );
+                static_assert( ((Pins_/16 == port_) and ...), "GpioBus- all pins must be on the same port" );
+
+                //port pin masks (1, 2 and 4 bit fields) for all pins
+                SCA mask_       { (u16)((1u<<(Pins_%16)) bitor ...) };
+                SCA fld2_       { ((1u<<(2*(Pins_%16))) bitor ...) };   //multiply by value to fill 2bit fields
+                SCA fld4lo_     { ((Pins_%16 < 8 ? 1u<<(4*(Pins_%16)) : 0) bitor ...) };
+                SCA fld4hi_     { ((Pins_%16 > 7 ? 1u<<(4*(Pins_%16-8)) : 0) bitor ...) };
+
+                //in order and contiguous- can simply shift
+                SCA isShift_    {
+                                []{ for( auto i = 1u; i < N_; i++ ) if( pins_[i] != pins_[i-1]+1 ) return false;
+                                    return true; }()
+                                };
+                SCA shift_      { pins_[0]%16 };
+                SCA valmask_    { (u16)((1u<<N_)-1) };
+
+                //value nibble -> port pins, one table of 16 for each nibble in the value
+                SCA NIBS_       { (N_+3)/4 };
+                struct          ScatterTbl { u16 v[NIBS_][16]; };
+                SCA scatterTbl_ {
+                                []{ ScatterTbl t{};
+                                    for( auto n = 0u; n < NIBS_; n++ )
+                                        for( auto v = 0u; v < 16; v++ )
+                                            for( auto b = 0u; b < 4 and n*4+b < N_; b++ )
+                                                if( v bitand (1<<b) ) t.v[n][v] or_eq 1<<(pins_[n*4+b]%16);
+                                    return t; }()
+                                };
+
+                II static GPIO_TypeDef&
+reg             () { return *(GPIO_TypeDef*)base_; }
+
+//-------------|
+    public:
+//-------------|
+
+                SCA mask        { mask_ };
+
+                //value -> port pin bits
+                II static constexpr u16
+scatter         (u16 v)
+                {
+                if constexpr( isShift_ ) return (v bitand valmask_)<<shift_;
+                u16 r = 0;
+                for( auto n = 0u; n < NIBS_; n++ ) r or_eq scatterTbl_.v[n][(v>>(4*n)) bitand 15];
+                return r;
+                }
+
+                //port pin bits -> value
+                II static constexpr u16
+gather          (u32 port)
+                {
+                if constexpr( isShift_ ) return (port>>shift_) bitand valmask_;
+                u16 r = 0;
+                for( auto i = 0u; i < N_; i++ ) if( port bitand (1<<(pins_[i]%16)) ) r or_eq 1<<i;
+                return r;
+                }
+
+                //no init, rcc clock enabled by default unless not wanted
+                II constexpr
+GpioBus         (bool clken = true) { if( clken ) enable(); }
+
+                II auto
+enable          () const { RCC->IOPENR or_eq (1<<port_); return *this; }
+
+// properties (all pins, one read-modify-write)
+
+                II auto
+mode            (PINS::MODE e) const
+                {
+                reg().MODER = (reg().MODER bitand compl (fld2_*3)) bitor (fld2_*e);
+                return *this;
+                }
+
+                II auto
+outType         (PINS::OTYPE e) const
+                {
+                if( e == PINS::ODRAIN ) reg().OTYPER or_eq mask_;
+                else reg().OTYPER and_eq compl mask_;
+                return *this;
+                }
+
+                II auto
+pull            (PINS::PULL e) const
+                {
+                reg().PUPDR = (reg().PUPDR bitand compl (fld2_*3)) bitor (fld2_*e);
+                return *this;
+                }
+
+                II auto
+speed           (PINS::SPEED e) const
+                {
+                reg().OSPEEDR = (reg().OSPEEDR bitand compl (fld2_*3)) bitor (fld2_*e);
+                return *this;
+                }
+
+                II auto
+altFunc         (PINS::ALTFUNC e) const
+                {
+                if constexpr( fld4lo_ != 0 ) reg().AFR[0] = (reg().AFR[0] bitand compl (fld4lo_*15)) bitor (fld4lo_*e);
+                if constexpr( fld4hi_ != 0 ) reg().AFR[1] = (reg().AFR[1] bitand compl (fld4hi_*15)) bitor (fld4hi_*e);
+                return mode( PINS::ALTERNATE );
+                }
+
+// read
+
+                II u16
+read            () const { return gather( reg().IDR ); }
+                II u16
+latVal          () const { return gather( reg().ODR ); }
+
+// write
+
+                //all pins set/reset in a single store
+                II auto
+write           (u16 v) const
+                {
+                auto s = scatter( v );
+                reg().BSRR = ((u32)(mask_ bitand compl s)<<16) bitor s;
+                return *this;
+                }
+
+                //only the pins in the value that are 1
+                II auto
+high            (u16 v) const { reg().BSRR = scatter( v ); return *this; }
+                II auto
+low             (u16 v) const { reg().BRR = scatter( v ); return *this; }
+                II auto
+toggle          (u16 v) const { return write( latVal() xor v ); }
+
+};
+
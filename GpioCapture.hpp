@@ -0,0 +1,139 @@
+#pragma once //GpioCapture.hpp
+
+#include "MyStm32.hpp"
+#include "Tim.hpp"
+#include "Dma.hpp"
+#include "Exti.hpp"
+
+/*=============================================================
+    GpioCapture - timer + dma gpio port capture (logic analyzer)
+
+    a timer update event triggers a dma transfer of the port IDR
+    (16bits) into a ram buffer, so a port can be sampled at up to
+    a few MHz with no cpu use
+
+    capture can start now, or when a trigger pin edge is seen (exti
+    irq via the Exti dispatcher, so a few us of latency)
+
+    when done, send() outputs the buffer in a run-length encoded
+    text form to any FMT::Print (the uart), and scripts/la2vcd.sh
+    converts that to a vcd file for viewing (gtkwave, pulseview)
+
+    channel names use the board pin labels (D0-D12 via board.D)-
+
+    static u16 buf[1024];
+    GpioCapture la{ PINS::PB0, Tim3, 2, buf, 1024 };
+    la.arm( 1000000, board.D[3], Exti::RISING ); //1MHz, trigger D3 rising
+    while( la.isBusy() ){}
+    la.send( uart, 'D', board.D, arraySize(board.D) );
+
+    output format (values in hex)-
+        LA <rate> <samples>
+        CH <name> <bit>     (one for each pin on the captured port)
+        <value> <count>     (run of count samples with the same value)
+        END
+=============================================================*/
+class GpioCapture {
+
+//-------------|
+    private:
+//-------------|
+
+                volatile u32& idr_;
+                u8 port_;
+                Tim tim_;
+                DmaCh dma_;
+                u16* buf_;
+                u16 n_;
+                u32 hz_{0};
+                u8 trigLine_{0xFF};
+
+                auto
+setup           (u32 hz)
+                {
+                hz_ = hz;
+                tim_.off().setRate( hz );
+                dma_.start( DmaCh::PER2MEM bitor DmaCh::MINC bitor DmaCh::W16 bitor DmaCh::PRIVHIGH,
+                            &idr_, buf_, n_, tim_.dmaUp );
+                tim_.dmaUpdateOn();
+                }
+
+                //exti trigger, start the timer (one time)
+                static void
+trigger         (void* p, Exti::EDGE)
+                {
+                auto& c = *static_cast<GpioCapture*>(p);
+                c.tim_.on();
+                c.untrigger();
+                }
+
+                auto
+untrigger       () -> void
+                {
+                if( trigLine_ > 15 ) return;
+                EXTI->IMR1 and_eq compl (1<<trigLine_);
+                Exti::detach( trigLine_ );
+                trigLine_ = 0xFF;
+                }
+
+//-------------|
+    public:
+//-------------|
+
+                //any pin on the port to capture (pin itself is not used)
+GpioCapture     (PINS::PIN portPin, timT t, u8 dmaCh, u16* buf, u16 n)
+                : idr_( GpioPin(portPin).reg_.IDR ), port_( portPin/16 ),
+                  tim_( t ), dma_( dmaCh ), buf_( buf ), n_( n )
+                {
+                }
+
+                //capture now
+                auto
+start           (u32 hz) { setup( hz ); tim_.on(); }
+
+                //capture when trigger pin edge seen
+                auto
+arm             (u32 hz, PINS::PIN trig, Exti::EDGE e)
+                {
+                stop();
+                setup( hz );
+                auto pin = GpioPin( trig ).mode( PINS::INPUT );
+                e == Exti::RISING ? pin.irqRising() : pin.irqFalling();
+                trigLine_ = pin.extiLine();
+                Exti::attach( trigLine_, trigger, this );
+                pin.irqOn();
+                }
+
+                auto
+stop            () -> void { untrigger(); tim_.off().dmaUpdateOff(); dma_.stop(); }
+
+                //armed/capturing
+                auto
+isBusy          () { return dma_.isBusy(); }
+
+                //samples captured so far
+                auto
+count           () { return n_ - dma_.remaining(); }
+
+                //rle output of the capture (only bits for the named pins)
+                auto
+send            (FMT::Print& p, char name, const PINS::PIN* pins, u8 npins)
+                {
+                u16 mask = 0;
+                auto n = count();
+                p << FMT::dec << "LA " << hz_ << ' ' << n << FMT::endl;
+                for( auto i = 0; i < npins; i++ ){
+                    if( pins[i]/16 != port_ ) continue;
+                    mask or_eq 1<<(pins[i]%16);
+                    p << "CH " << name << i << ' ' << (pins[i]%16) << FMT::endl;
+                    }
+                p << FMT::hex;
+                for( u16 i = 0; i < n; ){
+                    u16 v = buf_[i] bitand mask, run = 1;
+                    while( ++i < n and (buf_[i] bitand mask) == v ) run++;
+                    p << v << ' ' << run << FMT::endl;
+                    }
+                p << FMT::dec << "END" << FMT::endl;
+                }
+
+};
@@ -0,0 +1,100 @@
+#pragma once //GpioWave.hpp
+
+#include "MyStm32.hpp"
+#include "Tim.hpp"
+#include "Dma.hpp"
+
+/*=============================================================
+    GpioWave - timer + dma driven gpio waveform output
+
+    a buffer of BSRR words is precomputed, then a timer update event
+    triggers a dma transfer of one word to the port BSRR register at
+    each timer period- jitter free, and no cpu used while the buffer
+    is streamed out (any/all pins of a port, so can be 16 outputs)
+
+    buffer words are 32bits each (BSRR, which needs a word write to
+    both set and clear in one transfer), so ram use is 4 bytes per
+    time slot- the ws2812 helper below needs 3 slots per bit, so is
+    288 bytes per led, which limits it to a few leds with 8k of ram
+    (16 leds is 4.6k)- for a longer strip use a timer pwm channel
+    with dma to CCR instead (a byte per bit)
+
+    at 16MHz, keep the rate at ~2.5MHz or less (dma needs a few bus
+    cycles per transfer)
+
+    the pins are not configured here- BSRR only drives pins in output
+    mode, so set them first (or put them in a PinMap table)
+
+    static u32 buf[24*12+1]; //4 leds, 12 bytes
+    GpioPin( PINS::PB0 ).mode( PINS::OUTPUT ).speed( PINS::SPEED2 );
+    GpioWave wave{ PINS::PB0, Tim3, 1 }; //port of PB0, TIM3 update, dma ch1
+    auto n = GpioWave::ws2812( PINS::PB0, grb, 12, buf );
+    wave.play( buf, n, GpioWave::WS2812_HZ );
+    while( wave.isBusy() ){}
+=============================================================*/
+class GpioWave {
+
+//-------------|
+    private:
+//-------------|
+
+                volatile u32& bsrr_;
+                Tim tim_;
+                DmaCh dma_;
+
+//-------------|
+    public:
+//-------------|
+
+                //3 slots per bit (H-L-L is 0, H-H-L is 1), 1.31us bit time at 16MHz
+                SCA WS2812_HZ{ 16000000/7 };
+
+                //any pin on the port to use (pin itself is not used)
+GpioWave        (PINS::PIN portPin, timT t, u8 dmaCh)
+                : bsrr_( GpioPin(portPin).reg_.BSRR ), tim_( t ), dma_( dmaCh )
+                {
+                }
+
+                auto
+stop            ()
+                {
+                tim_.off().dmaUpdateOff();
+                dma_.stop();
+                return *this;
+                }
+
+                //output n words at hz rate, optionally repeat (circular) until stop()
+                auto
+play            (const u32* buf, u16 n, u32 hz, bool repeat = false)
+                {
+                stop();
+                tim_.setRate( hz );
+                dma_.start( DmaCh::MEM2PER bitor DmaCh::MINC bitor DmaCh::W32 bitor DmaCh::PRIVHIGH bitor
+                            (repeat ? DmaCh::CIRC : 0), &bsrr_, buf, n, tim_.dmaUp );
+                tim_.dmaUpdateOn().on();
+                return *this;
+                }
+
+                auto
+isBusy          () { return dma_.isBusy(); }
+
+                //encode ws2812 bytes (grb order, msb first) to BSRR words
+                //3 words per bit, buffer needs 24 words per byte (returns words used)
+                //a final low word is added for the idle state (+1 word)
+                static u16
+ws2812          (PINS::PIN pin, const u8* data, u16 n, u32* buf)
+                {
+                u32 hi = 1<<(pin%16), lo = hi<<16;
+                auto p = buf;
+                for( auto i = 0; i < n; i++ ){
+                    for( u8 bm = 0x80; bm; bm >>= 1 ){
+                        *p++ = hi;
+                        *p++ = (data[i] bitand bm) ? hi : lo;
+                        *p++ = lo;
+                        }
+                    }
+                *p++ = lo;
+                return p - buf;
+                }
+
+};
@@ -1,6 +1,8 @@
 #pragma once //Lptim.hpp
 
 #include "MyStm32.hpp"
+#include "Tim.hpp"
+#include "TimerWheel.hpp"
 
 /*=============================================================
     RccLptim - RCC functions for LPTIM1, LPTIM2
@@ -57,10 +59,12 @@ struct Lptim : RccLptim {
 //-------------|
 
                 //useful private enum values
-                enum { ENABLEbm = 1<<0, CNTSTRTbm = 1<<2 };
+                enum { ENABLEbm = 1<<0, SNGSTRTbm = 1<<1, CNTSTRTbm = 1<<2 };
 
                 //vars
                 LPTIM_TypeDef& lptim_;
+                bool cmpBusy_{false};   //CMP written, CMPOK not yet seen
+                bool arrBusy_{false};   //ARR written, ARROK not yet seen
                 static inline Lptim* instances_[2]; //for isr use
 
 
@@ -111,7 +115,7 @@ Lptim           (LPTIM_TypeDef* t)
                 //marked as ON OFF in comments
 
                 auto
-reset           (){ RccLptim::reset( lptim_ ); return *this; }
+reset           (){ RccLptim::reset( lptim_ ); cmpBusy_ = arrBusy_ = false; return *this; }
                 auto
 on              (){ lptim_.CR or_eq ENABLEbm; return *this; }
                 auto
@@ -122,6 +126,35 @@ intClock        () { off(); lptim_.CFGR and_eq compl 1; return *this; }
 extClock        () { off(); lptim_.CFGR or_eq 1; return *this; }
                 auto
 startContinuous (){ on(); lptim_.CR or_eq CNTSTRTbm; return *this;  }
+                auto
+startSingle     (){ on(); lptim_.CR or_eq SNGSTRTbm; return *this;  }
+                //clock divided by 2^n (n = 0-7)
+                auto //OFF
+prescaler       (u8 n)
+                {
+                off();
+                lptim_.CFGR = (lptim_.CFGR bitand compl LPTIM_CFGR_PRESC) bitor (n bitand 7)<<LPTIM_CFGR_PRESC_Pos;
+                return *this;
+                }
+                //output pin (pwm waveform)- normally active high after CMP match
+                //until the end of the period, inverted is active low
+                auto //OFF
+outInvert       (bool tf)
+                {
+                off();
+                if( tf ) lptim_.CFGR or_eq LPTIM_CFGR_WAVPOL;
+                else lptim_.CFGR and_eq compl LPTIM_CFGR_WAVPOL;
+                return *this;
+                }
+                //preload- ARR/CMP writes take effect at the end of the current period
+                auto //OFF
+preload         (bool tf)
+                {
+                off();
+                if( tf ) lptim_.CFGR or_eq LPTIM_CFGR_PRELOAD;
+                else lptim_.CFGR and_eq compl LPTIM_CFGR_PRELOAD;
+                return *this;
+                }
 
                 //IRQTYPE is bitmask value, use as-is
                 auto
@@ -140,9 +173,34 @@ irqOff          (IRQTYPE e) { off(); lptim_.IER and_eq compl e; return *this; }
                 auto
 irqIsFlag       (IRQTYPE e) { return lptim_.ISR bitand e; }
 
-                //note- preload not in use, arr value is written 'now'
+                //arr value is written 'now' unless preload is in use, and
+                //like CMP, wait for any previous write to complete (ARROK)
                 auto //ON
-setReload       (u16 v) { on(); lptim_.ARR = v; return *this; }
+setReload       (u16 v)
+                {
+                on();
+                if( arrBusy_ ) while( not irqIsFlag(ARROK) ){}
+                irqClear( ARROK );
+                lptim_.ARR = v;
+                arrBusy_ = true;
+                return *this;
+                }
+                //a CMP write takes a few lptim clocks to complete, so wait for
+                //any previous write to complete (CMPOK) before writing again
+                auto //ON
+setCompare      (u16 v)
+                {
+                on();
+                if( cmpBusy_ ) while( not irqIsFlag(CMPOK) ){}
+                irqClear( CMPOK );
+                lptim_.CMP = v;
+                cmpBusy_ = true;
+                return *this;
+                }
+                //previous CMP write complete, so setCompare will not wait (with
+                //an external clock the write only completes on input edges)
+                bool
+compareReady    () { return not cmpBusy_ or irqIsFlag(CMPOK); }
                 auto //read twice, valid if both the same value
 count           () { u16 v; while( v = lptim_.CNT, v != lptim_.CNT ){} return v; }
 
@@ -166,6 +224,10 @@ clockSource     (CLKSRC e)
     LptimRepeatDo - low power timer (LPTIM1, LPTIM2)
     internal LSI only, ~32khz
     simple usage to run a function at intervals < ~2sec
+    preload is used, so a period change (setPeriod, or reinit
+    with the same function) is a single ARR write that takes
+    effect at the end of the current period- no reset, no
+    lost or short periods (can be called from the function)
 =============================================================*/
                 //ms -> lsi counts (max 2048ms)
                 SCA
@@ -200,15 +262,20 @@ reinit          (void(*isrfunc)(), u16 arrVal)
                 isrFunc_ = isrfunc;
                 if( not isrfunc ) return;           //no function, so nothing more to do
                     clockSource( LSI )
+                    .preload( true )
                     .irqOn( ARRM )
                     .setReload( arrVal )
                     .startContinuous();
                 }
 
+                //next period, running timer is not reset
+                auto
+setPeriod       (u16 arrVal) { setReload( arrVal ); }
+
                 void
 reinit          (u16 arrVal)                        //reuse previously set function
                 {
-                reinit( isrFunc_, arrVal );
+                if( isrFunc_ ) setPeriod( arrVal ); //already running
                 }
 
 
@@ -230,15 +297,20 @@ LptimRepeatDo   (LPTIM_TypeDef* t, void(*isrfunc)(), u16 arrVal)   //(use _ms_lp
     LPTIM1_IN1 = PB5, AF5
     LPTIM2_IN1 = PB1, AF5
     uses lptimT from our mcu header, which has pin IN1 info
+    (pinInit false if IN1 is configured by a PinMap table)
 =============================================================*/
 struct LptimExtCounter : Lptim {
 
 //-------------|
-    private:
+    protected:
 //-------------|
 
                 //vars
-                volatile u16 pulseCountH_;//upper 16bits (CNT is lower 16bits)
+                //upper 16bits (CNT is lower 16bits), the isr only increments
+                //this, so count() can read without an InterruptLock (see ReadDelta
+                //in Util.hpp for the same technique on other counters)
+                volatile u16 pulseCountH_;
+                const IRQTYPE irqs_;    //ARRM, + CMPM for LptimFreqMeter
 
                 //functions
 
@@ -258,28 +330,567 @@ reinit          ()
                 {
                 reset()
                     .clockSource( EXTIN )
-                    .irqOn( ARRM )
+                    .irqOn( irqs_ )
                     .setReload( 65535 )
                     .startContinuous();
                 }
 
-                auto
+                //read CNT before and after the upper part and the ARRM flag, if
+                //CNT and the upper part unchanged then they belong together (no
+                //lock needed)- ARRM is set at CNT == 0xFFFF (one count before
+                //the wrap), so the upper part counts from CNT 0xFFFF, which is
+                //made up for by the +1,-1 on CNT (and a pending ARRM not yet
+                //seen by the isr is added here)
+                u32
 count           ()
                 {
                 while( true ){
                     auto vL = Lptim::count();
-                    auto vH = pulseCountH_;
-                    if( vL == Lptim::count() ) return (vH<<16) bitor vL;
+                    u32 vH = pulseCountH_;
+                    bool w = irqIsFlag( ARRM );
+                    if( vL != Lptim::count() or vH != pulseCountH_ ) continue;
+                    if( w ) vH++;
+                    return (vH<<16) + (u16)(vL+1) - 1;
                     }
                 }
 
 
-LptimExtCounter (lptimT t)
-                : Lptim( t.lptim )
+LptimExtCounter (lptimT t, bool pinInit = true) : LptimExtCounter( t, pinInit, ARRM ) {}
+
+//-------------|
+    protected:
+//-------------|
+
+                //derived class irqs (ARRM always), so the lptim is configured
+                //once by this constructor
+LptimExtCounter (lptimT t, bool pinInit, IRQTYPE irqs)
+                : Lptim( t.lptim ), irqs_( IRQTYPE(irqs bitor ARRM) )
                 {
-                GpioPin( t.in1 ).mode(INPUT).pull(PULLDOWN).altFunc(AF5);
+                if( pinInit ) GpioPin( t.in1 ).mode(INPUT).pull(PULLDOWN).altFunc(t.in1AltFunc);
                 reinit();
                 }
 
 };
 
+
+
+/*=============================================================
+    LptimFreqMeter - frequency/period of the pulses counted by
+    LptimExtCounter, gate time from a TIM (cpu clock, so precise)
+
+    high frequency- pulses counted over each gate period
+    low frequency (under RECIP_BELOW_ pulses per gate)- reciprocal,
+        the gate arms a compare on the next pulse, and the time
+        between these pulses (and the pulse count) is the reading,
+        so resolution is the tick rate (100kHz) instead of 1 pulse
+
+    readings are double buffered, one isr per gate period at most
+    publishes a new reading, a read is lock free (retry if a new
+    reading was published while copying)
+
+    TIM stops in stop mode, so use sleep mode while measuring
+
+    LptimFreqMeter meter{ Lptim2_PB1, Tim14, 100 }; //100ms gate
+    auto mhz = meter.milliHz();
+    auto us = meter.periodUs();
+=============================================================*/
+struct LptimFreqMeter : LptimExtCounter {
+
+//-------------|
+    public:
+//-------------|
+
+                SCA TICK_HZ     { 100000ul };   //gate timer tick rate
+
+                struct Reading {
+                    u32 pulses;                 //0 = no pulses before timeout
+                    u32 ticks;                  //time of these pulses, TICK_HZ
+                    bool reciprocal;
+                    };
+
+//-------------|
+    private:
+//-------------|
+
+                SCA RECIP_BELOW_{ 1000 };   //pulses per gate, 0.1% resolution
+
+                TIM_TypeDef& gate_;
+                const IRQn_Type gateIrq_;
+                const u32 gateTicks_;
+                const u32 timeoutGates_;
+                static inline LptimFreqMeter* instances_[2]; //LPTIM1, LPTIM2
+
+                Reading readings_[2]{};
+                volatile u32 seq_{0};       //readings_[seq_ bitand 1] is current
+
+                u32 gates_{0};              //gate periods, time = gates_*gateTicks_
+                u32 gateCount_{0};          //pulse count at last gate
+                bool armed_{false};         //compare armed for next pulse
+                u16 armCmp_{0};             //compare value armed
+                u32 armGate_{0};            //gate when armed (or last pulse)
+                bool haveEdge_{false};      //edge values below are valid
+                u32 edgeCount_{0};
+                u32 edgeTime_{0};
+
+                auto
+publish         (u32 pulses, u32 ticks, bool recip)
+                {
+                auto i = (seq_ + 1) bitand 1;
+                readings_[i] = { pulses, ticks, recip };
+                seq_ = seq_ + 1;
+                }
+
+                //timestamp in ticks, from an isr other than the gate isr
+                //(update not yet seen by the gate isr is added)
+                auto
+ticks           ()
+                {
+                u32 c = gate_.CNT;
+                u32 g = gates_;
+                if( (gate_.SR bitand TIM_SR_UIF) and c < gateTicks_/2 ) g++;
+                return g*gateTicks_ + c;
+                }
+
+                //no waiting for a previous CMP write in the gate isr (the
+                //lptim is clocked by the input, so CMPOK may never come), if
+                //not ready then left unarmed and tried again next gate
+                auto
+arm             (u32 count)
+                {
+                armed_ = false;
+                if( not compareReady() ) return;
+                armCmp_ = count + 1;
+                setCompare( armCmp_ );
+                armed_ = true;
+                }
+
+                //gate timer update
+                auto
+gate            ()
+                {
+                gate_.SR = compl TIM_SR_UIF; //rc_w0
+                gates_++;
+                auto c = count();
+                auto n = c - gateCount_;
+                gateCount_ = c;
+                if( n >= RECIP_BELOW_ ){
+                    armed_ = false;
+                    haveEdge_ = false;
+                    armGate_ = gates_;
+                    return publish( n, gateTicks_, false );
+                    }
+                if( not armed_ ) arm( c );
+                //armed, check compare write was not too late for the pulse
+                //(count passed without a match, and no match pending)
+                else if( (u16)(c - armCmp_) < 0x8000 and not irqIsFlag(CMPM) ) arm( c );
+                if( gates_ - armGate_ < timeoutGates_ ) return;
+                armGate_ = gates_;
+                haveEdge_ = false;
+                publish( 0, timeoutGates_*gateTicks_, true );
+                }
+
+                //lptim isr- counter wrap (LptimExtCounter), or compare match
+                void
+isr             () override
+                {
+                if( irqIsFlag(ARRM) ) LptimExtCounter::isr();
+                if( not irqIsFlag(CMPM) ) return;
+                irqClear( CMPM );
+                if( not armed_ ) return; //old compare value, count passed it again
+                auto t = ticks();
+                auto c = count();
+                c -= (u16)(c - armCmp_); //count at the pulse
+                armed_ = false;
+                if( haveEdge_ ) publish( c - edgeCount_, t - edgeTime_, true );
+                haveEdge_ = true;
+                armGate_ = gates_;
+                edgeCount_ = c;
+                edgeTime_ = t;
+                }
+
+                static void
+isrAll          ()
+                {
+                auto n = irqActive();
+                auto ptr = instances_[0] and instances_[0]->gateIrq_ == n ? instances_[0] : instances_[1];
+                ptr->gate();
+                }
+
+//-------------|
+    public:
+//-------------|
+
+                //gateMs 1-655, timeoutMs- no pulses for this long reads as 0Hz
+LptimFreqMeter  (lptimT t, timT gate, u16 gateMs = 100, u16 timeoutMs = 2000, bool pinInit = true)
+                : LptimExtCounter( t, pinInit, CMPM ), //configured once, with CMPM
+                  gate_( *gate.tim ), gateIrq_( gate.irqn ),
+                  gateTicks_( gateMs*(TICK_HZ/1000) ),
+                  timeoutGates_( (timeoutMs + gateMs - 1)/gateMs )
+                {
+                instances_[ t.lptim == LPTIM1 ? 0 : 1 ] = this;
+                Tim tim{ gate };
+                tim.setPeriod( System::cpuMHz*1000000ul/TICK_HZ - 1, gateTicks_ - 1 );
+                gate_.DIER = TIM_DIER_UIE;
+                irqFunction( gate.irqn, isrAll );
+                tim.on();
+                }
+
+                //latest reading, lock free
+                auto
+reading         ()
+                {
+                Reading r; u32 s;
+                do{
+                    s = seq_;
+                    r = readings_[s bitand 1];
+                    } while( s != seq_ );
+                return r;
+                }
+
+                //reading number, changes when a new reading is available
+                auto
+readings        () { return seq_; }
+
+                auto
+milliHz         ()
+                {
+                auto r = reading();
+                return r.ticks ? (u32)(r.pulses*(TICK_HZ*1000ull)/r.ticks) : 0;
+                }
+
+                //0 if no pulses
+                auto
+periodUs        ()
+                {
+                auto r = reading();
+                return r.pulses ? (u32)(r.ticks*(1000000ull/TICK_HZ)/r.pulses) : 0;
+                }
+
+};
+
+
+
+
+/*=============================================================
+    LptimTimers - software timers on one low power timer
+    internal LSI only, ~32khz
+
+    any number of one-shot or periodic timers share one LPTIM, the
+    timer nodes are supplied by the user (no allocation), start and
+    cancel are O(1) (timing wheel- a list per time slot plus a bitmap
+    of slots in use, see TimerWheel.hpp), a timer function can start
+    or cancel any timer
+
+    tickless- the compare register is set to the next deadline so
+    the isr only runs when a timer is due (or at the 2s counter wrap)
+    timer functions are called from the lptim isr
+
+    times in lsi ticks (1/32ms), use _ms_lpticks (or _ms_lptim for
+    times up to 2048ms)
+
+    also a monotonic 64bit time base- now(), timeouts, and sleepUntil()
+    which uses stop mode while waiting (lptim on lsi keeps running, and
+    its compare match wakes the cpu), so can replace busy wait delays
+
+    LptimTimers timers{ LPTIM1 };
+    LptimTimers::Timer blink{ []{ board.led.toggle(); } };
+    timers.start( blink, 500_ms_lpticks, true ); //periodic
+    timers.cancel( blink );
+=============================================================*/
+                //ms -> lsi ticks, no 2048ms limit
+                SCA
+operator "" _ms_lpticks(u64 ms) -> u32 { return ms*32ul; }
+
+
+struct LptimTimers : Lptim {
+
+//-------------|
+    public:
+//-------------|
+
+                using Timer = TimerWheel::Timer;
+
+//-------------|
+    private:
+//-------------|
+
+                SCA MARGIN_     { 4 };      //ticks, compare needs time to take effect
+                SCA MAXWAIT_    { 0xF000 }; //16bit counter
+
+                TimerWheel wheel_;          //slot is 1024 ticks (32ms), wheel is ~1s
+                volatile u32 high_{0};      //counter wraps
+                u32 next_{0};               //current compare deadline
+
+                //set compare to deadline (if in time)
+                auto
+program         (u32 deadline, u32 now)
+                {
+                if( (i32)(deadline - now) < MARGIN_ ) deadline = now + MARGIN_;
+                next_ = deadline;
+                setCompare( deadline bitand 0xFFFF );
+                }
+
+                //run due timers in all slots passed since last time, then
+                //set compare to next deadline (again if already due)
+                auto
+service         ()
+                {
+                while( true ){
+                    auto now = time();
+                    wheel_.run( now );
+                    auto next = wheel_.next( now, MAXWAIT_ );
+                    now = time();
+                    if( (i32)(next - now) >= MARGIN_ ) return program( next, now );
+                    }
+                }
+
+                void
+isr             () override
+                {
+                if( irqIsFlag(ARRM) ){ irqClear( ARRM ); high_ = high_ + 1; }
+                irqClear( CMPM );
+                service();
+                }
+
+//-------------|
+    public:
+//-------------|
+
+LptimTimers     (LPTIM_TypeDef* t)
+                : Lptim(t)
+                {
+                reset()
+                    .clockSource( LSI )
+                    .irqOn( IRQTYPE(CMPM bitor ARRM) )
+                    .setReload( 65535 )
+                    .startContinuous();
+                wheel_.init( 0 );
+                program( MAXWAIT_, 0 );
+                }
+
+                //monotonic tick count, 16bit counter extended in software by the
+                //wrap count (48bits used, will not wrap), isr only increments
+                //high_, so no lock needed- high_, CNT and ARRM are re-read until
+                //high_ and CNT are unchanged so all three belong together, ARRM is
+                //set at CNT == 0xFFFF (one tick before the wrap), so high_ counts
+                //from CNT 0xFFFF which is made up for by the +1,-1 on CNT- a pending
+                //ARRM not yet seen by the isr (CNT 0xFFFF or already wrapped) is
+                //always one more epoch
+                u64
+now             ()
+                {
+                u32 h; u16 c; bool w;
+                do{
+                    h = high_;
+                    c = Lptim::count();
+                    w = irqIsFlag( ARRM );
+                    } while( h != high_ or c != Lptim::count() );
+                if( w ) h++;
+                return ((u64)h<<16) + (u16)(c+1) - 1;
+                }
+
+                //lower 32bits of now() (~36 hours), deadlines compared as signed difference
+                u32
+time            () { return now(); }
+
+                //timeouts
+                auto
+deadline        (u32 ticks) { return now() + ticks; }
+                auto
+isExpired       (u64 deadline) { return now() >= deadline; }
+
+                //start (or restart) a timer, ticks from now
+                auto
+start           (Timer& t, u32 ticks, bool periodic = false)
+                {
+                if( ticks == 0 ) ticks = 1;
+                InterruptLock lock;
+                wheel_.remove( t );
+                auto now = time();
+                t.deadline = now + ticks;
+                t.period = periodic ? ticks : 0;
+                wheel_.add( t );
+                if( (i32)(t.deadline - next_) < 0 ) program( t.deadline, now );
+                }
+
+                auto
+cancel          (Timer& t)
+                {
+                InterruptLock lock;
+                wheel_.remove( t );
+                }
+
+                auto
+isActive        (Timer& t) { return TimerWheel::isActive( t ); }
+
+                //sleep until deadline, timers keep running (their functions are
+                //called from the isr as usual), stop mode used unless deepOk
+                //returns false (a peripheral not clocked in stop mode still busy,
+                //like a uart transmitting), then sleep mode is used for that wait
+                auto
+sleepUntil      (u64 deadline, bool(*deepOk)() = nullptr)
+                {
+                Timer wake{ []{} }; //only needs to wake the cpu
+                while( true ){
+                    InterruptLock lock; //wfi still wakes on a pending irq, which
+                                        //then runs when the lock goes out of scope
+                    auto t = now();
+                    if( t >= deadline ) break;
+                    auto ticks = deadline - t;
+                    start( wake, ticks > 0x7FFFFFFF ? 0x7FFFFFFF : ticks );
+                    idle( not deepOk or deepOk() );
+                    }
+                cancel( wake );
+                }
+
+                auto
+sleepFor        (u32 ticks, bool(*deepOk)() = nullptr) { sleepUntil( deadline(ticks), deepOk ); }
+
+};
+
+
+
+
+
+/*=============================================================
+    LptimPwm - low power timer (LPTIM1, LPTIM2) pwm or one pulse
+    output on LPTIMx_OUT
+    LPTIM1_OUT = PB2, AF5
+    LPTIM2_OUT = PA4, AF5
+    uses lptimT from our mcu header, which has pin OUT info
+    (pinInit false if OUT is configured by a PinMap table)
+
+    with LSI (or LSE) as the clock source the output keeps running
+    in stop mode, no cpu needed (led dimming, buzzer tones)
+
+    output is active from CMP+1 to ARR (see outInvert), so the
+    active time is 1 to period-1 ticks, stop() for no output
+    preload is used so period/duty changes take effect at the
+    end of the current period (first period after start is short,
+    as ARR starts at its reset value)
+
+    LptimPwm buzzer{ Lptim2 };
+    buzzer.frequency( 2000 ); //2kHz, 50%
+    LptimPwm led{ Lptim1 };
+    led.period( 320 ).duty( 32 ); //100Hz, 10%
+=============================================================*/
+struct LptimPwm : Lptim {
+
+//-------------|
+    private:
+//-------------|
+
+                const CLKSRC clk_;
+                u8 presc_{0};
+                u32 period_{2};     //ticks (ARR+1)
+                bool isOn_{false};  //pwm running
+
+                auto
+config          (bool preload)
+                {
+                reset()
+                    .clockSource( clk_ )
+                    .prescaler( presc_ )
+                    .preload( preload );
+                }
+
+//-------------|
+    public:
+//-------------|
+
+LptimPwm        (lptimT t, CLKSRC clk = LSI, bool pinInit = true)
+                : Lptim( t.lptim ), clk_( clk )
+                {
+                if( pinInit ) GpioPin( t.out ).mode(ALTERNATE).altFunc(t.outAltFunc);
+                }
+
+                //clock source in Hz (after prescaler)
+                auto
+clockHz         ()
+                {
+                u32 hz = clk_ == LSI ? 32000 : clk_ == LSE ? 32768 :
+                         clk_ == HSI16 ? 16000000 : System::cpuMHz*1000000ul;
+                return hz>>presc_;
+                }
+
+                //start pwm (or restart after pulse/stop), period in ticks (2-65536)
+                auto
+start           (u32 periodTicks, u32 activeTicks) -> LptimPwm&
+                {
+                config( true );
+                period_ = periodTicks > 65536 ? 65536 : periodTicks < 2 ? 2 : periodTicks;
+                setReload( period_ - 1 );
+                duty( activeTicks );
+                startContinuous();
+                isOn_ = true;
+                return *this;
+                }
+
+                //change period, running output is not restarted (duty unchanged
+                //in ticks, so call duty after)
+                auto
+period          (u32 ticks) -> LptimPwm&
+                {
+                period_ = ticks > 65536 ? 65536 : ticks < 2 ? 2 : ticks;
+                setReload( period_ - 1 );
+                return *this;
+                }
+
+                //active ticks, clamped to 1 to period-1 (u32, so a period of
+                //65536 and out of range values are not truncated)
+                auto
+duty            (u32 ticks) -> LptimPwm&
+                {
+                auto top = period_ - 1;
+                if( ticks < 1 ) ticks = 1;
+                if( ticks > top ) ticks = top;
+                setCompare( top - ticks );
+                return *this;
+                }
+
+                //percent of period (0-100), u32 math then clamped by duty
+                auto
+dutyPct         (u8 pct) -> LptimPwm&
+                {
+                u32 p = pct > 100 ? 100 : pct;
+                return duty( period_*p/100 );
+                }
+
+                //frequency in Hz with duty in percent, prescaler set as needed
+                //(restarts the output only if the prescaler changes)
+                auto
+frequency       (u32 hz, u8 pct = 50) -> LptimPwm&
+                {
+                if( not hz ) hz = 1;
+                auto base = clockHz()<<presc_;
+                u8 n = 0;
+                while( n < 7 and (base>>n)/hz > 65536 ) n++;
+                auto restart = n != presc_ or not isOn_;
+                presc_ = n;
+                u32 ticks = clockHz()/hz;
+                if( restart ) start( ticks, 1 );
+                else period( ticks );
+                return dutyPct( pct );
+                }
+
+                //single pulse- inactive for delayTicks (1+), then active for
+                //widthTicks (1+, total up to 65536), output stays inactive
+                //after (preload not used)
+                auto
+pulse           (u16 delayTicks, u16 widthTicks) -> LptimPwm&
+                {
+                if( delayTicks < 1 ) delayTicks = 1;
+                if( widthTicks < 1 ) widthTicks = 1;
+                u32 top = delayTicks + widthTicks - 1;
+                config( false );
+                isOn_ = false;
+                setReload( top > 65535 ? 65535 : top );
+                setCompare( delayTicks - 1 );
+                startSingle();
+                return *this;
+                }
+
+                auto
+stop            () -> LptimPwm& { off(); isOn_ = false; return *this; }
+
+};
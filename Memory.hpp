@@ -0,0 +1,83 @@
+#pragma once //Memory.hpp
+
+#include "MyStm32.hpp"
+
+//linker symbols (_sramvector, _sstack declared in Util.hpp)
+extern u32 _eramvector[];
+extern u32 _sramdebug[], _eramdebug[];
+extern u32 _srelocate[], _erelocate[];
+extern u32 _szero[], _ezero[];
+extern u32 _snoinit[], _enoinit[];
+extern u32 _sheap[], _eheap[];
+extern u32 _estack[];
+
+/*=============================================================
+    Memory - ram use from the linker symbols, and peak stack use
+
+    startup.cpp paints the unused stack (from _sstack up to the
+    stack in use at reset) with STACK_PAINT, so the lowest word no
+    longer holding that value is the deepest the stack has been
+
+    sizes in bytes
+
+    Memory::report( uart ); //any Print (or anything with <<)
+    auto free = Memory::stackFree(); //never used so far
+=============================================================*/
+struct Memory {
+
+//-------------|
+    private:
+//-------------|
+
+                SCA STACK_PAINT{ 0xA5A5A5A5 }; //same value in startup.cpp
+
+                static u32
+size            (const void* s, const void* e) { return (const u8*)e - (const u8*)s; }
+
+//-------------|
+    public:
+//-------------|
+
+                static u32
+ramvector       () { return size( _sramvector, _eramvector ); }
+                static u32
+ramdebug        () { return size( _sramdebug, _eramdebug ); }
+                static u32
+data            () { return size( _srelocate, _erelocate ); }
+                static u32
+bss             () { return size( _szero, _ezero ); }
+                static u32
+noinit          () { return size( _snoinit, _enoinit ); }
+                static u32
+heap            () { return size( _sheap, _eheap ); }
+                //all ram after the heap
+                static u32
+stack           () { return size( &_sstack, _estack ); }
+
+                //deepest stack use so far (first 2 words not painted)
+                static u32
+stackPeak       ()
+                {
+                auto p = (u32*)&_sstack + 2;
+                while( p < _estack and *p == STACK_PAINT ) p++;
+                return size( p, _estack );
+                }
+
+                static u32
+stackFree       () { return stack() - stackPeak(); }
+
+                template<typename P>
+                static void
+report          (P& out)
+                {
+                out << "ramvector " << ramvector() << "\r\n"
+                    << "ramdebug  " << ramdebug() << "\r\n"
+                    << "data      " << data() << "\r\n"
+                    << "bss       " << bss() << "\r\n"
+                    << "noinit    " << noinit() << "\r\n"
+                    << "heap      " << heap() << "\r\n"
+                    << "stack     " << stack() << " peak " << stackPeak()
+                    << " free " << stackFree() << "\r\n";
+                }
+
+};
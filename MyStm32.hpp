@@ -47,7 +47,8 @@ using namespace UTIL;
 inline Boards::Nucleo32g031 board;      //everyone can access
 
 inline u8 uartBuffer[64];               //create a buffer for uart
-inline Uart uart{ board.uart, 1000000, uartBuffer, 64 }; //everyone can access
+inline Uart uart{ board.uart, 1000000, uartBuffer, 64, false }; //everyone can access
+                                        //(tx pin is in board.pins)
 
 using namespace PINS;                   //bring into global namespace
 using namespace FMT;
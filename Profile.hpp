@@ -0,0 +1,139 @@
+#pragma once //Profile.hpp
+
+#include "MyStm32.hpp"
+
+/*=============================================================
+    Profile - time code scopes in cpu cycles (no DWT on the M0+,
+    so uses Systick::cycles- SysTick counter plus its ms count, so
+    Systick must be started, Systick::init)
+
+    each probe keeps count, min, max, total (for the mean), and a
+    log2 histogram (bin n is 2^n to 2^(n+1)-1 cycles), probes add
+    themselves to a static table the first time they are used
+
+    PROFILE_ENABLE 0 (default) compiles PROFILE() to nothing and
+    report() to an empty function, so probes can be left in place
+
+    #define PROFILE_ENABLE 1 //before any include (or -DPROFILE_ENABLE=1)
+    #include "Profile.hpp"
+
+    void isr() {
+        PROFILE( "uart isr" ); //times until end of scope
+        ...
+        }
+    Profile::report( uart );
+
+    the time includes about 100 cycles of overhead (two cycles() reads),
+    an interrupt in the scope is included in the time
+=============================================================*/
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE 0
+#endif
+
+struct Profile {
+
+//-------------|
+    public:
+//-------------|
+
+                SCA BINS{ 24 }; //up to 16M cycles, larger go in the last bin
+                SCA PROBES{ 16 };
+
+                struct Probe {
+                    const char* name;
+                    u32 count{0};
+                    u32 min{0xFFFFFFFF};
+                    u32 max{0};
+                    u64 total{0};
+                    u16 hist[BINS]{};   //saturates
+                    bool listed{false};
+
+                    constexpr Probe(const char* nam) : name(nam) {}
+
+                    auto
+                    add (u32 cycles)
+                        {
+                        InterruptLock lock; //probe may be shared by main and isr
+                        if( not listed ) Profile::list( *this );
+                        count++;
+                        total += cycles;
+                        if( cycles < min ) min = cycles;
+                        if( cycles > max ) max = cycles;
+                        u8 b = 0;
+                        while( (cycles >>= 1) and b < BINS-1 ) b++;
+                        if( hist[b] != 0xFFFF ) hist[b]++;
+                        }
+                    };
+
+                //RAII, times its lifetime
+                class Scope {
+                    Probe& probe_;
+                    u32 start_;
+                public:
+                    Scope(Probe& p) : probe_(p), start_(Systick::cycles()) {}
+                    ~Scope(){ probe_.add( Systick::cycles() - start_ ); }
+                    };
+
+//-------------|
+    private:
+//-------------|
+
+                static inline Probe* probes_[PROBES];
+                static inline u8 count_;
+
+                static void
+list            (Probe& p)
+                {
+                p.listed = true;
+                if( count_ < PROBES ) probes_[count_++] = &p;
+                }
+
+//-------------|
+    public:
+//-------------|
+
+                //name count min mean max (cycles), then the histogram bins in use
+                static void
+report          (FMT::Print& out)
+                {
+                #if PROFILE_ENABLE
+                out << FMT::dec << "name count min mean max (cycles at "
+                    << System::cpuMHz << "MHz)" << FMT::endl;
+                for( u8 i = 0; i < count_; i++ ){
+                    Probe p{ "" };
+                    { InterruptLock lock; p = *probes_[i]; } //consistent copy
+                    if( not p.count ) continue;
+                    out << p.name << ' ' << p.count << ' ' << p.min << ' '
+                        << (u32)(p.total/p.count) << ' ' << p.max << FMT::endl;
+                    for( u8 b = 0; b < BINS; b++ ){
+                        if( not p.hist[b] ) continue;
+                        out << "  " << FMT::setw(8) << (1ul<<b) << ' ' << p.hist[b] << FMT::endl;
+                        }
+                    }
+                #else
+                (void)out;
+                #endif
+                }
+
+                static void
+reset           ()
+                {
+                InterruptLock lock;
+                for( u8 i = 0; i < count_; i++ ){
+                    auto name = probes_[i]->name;
+                    *probes_[i] = Probe{ name };
+                    probes_[i]->listed = true;
+                    }
+                }
+
+};
+
+#define PROFILE_CAT_(a,b) a##b
+#define PROFILE_CAT(a,b) PROFILE_CAT_(a,b)
+#if PROFILE_ENABLE
+#define PROFILE(nam) \
+    static Profile::Probe PROFILE_CAT(profileProbe_,__LINE__){ nam }; \
+    Profile::Scope PROFILE_CAT(profileScope_,__LINE__){ PROFILE_CAT(profileProbe_,__LINE__) }
+#else
+#define PROFILE(nam)
+#endif
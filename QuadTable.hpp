@@ -0,0 +1,24 @@
+#pragma once //QuadTable.hpp
+
+/*-----------------------------------------------------------------------------
+    QuadTable - quadrature state transition table
+
+    index is (previous AB state<<2) bitor (current AB state), A=bit1, B=bit0
+    value is the count change, or ERR if both pins changed (a missed state)
+    contact bounce on one pin produces +1/-1 pairs, so cancels out
+
+    no includes, only needs the i8 type (MyStm32.hpp), so it can also
+    be used by the host test in tests/
+-----------------------------------------------------------------------------*/
+struct QuadTable {
+
+                enum { ERR = 2 };
+
+                static constexpr i8 tbl[16]{
+                    0, -1,  1, ERR,
+                    1,  0, ERR, -1,
+                   -1, ERR, 0,  1,
+                   ERR, 1, -1,  0
+                    };
+
+};
@@ -0,0 +1,115 @@
+#pragma once //Rng.hpp
+
+namespace UTIL {
+
+/*-----------------------------------------------------------------------------
+    Rng - xoshiro128** random number generator, state is the object
+    so each user (main, an isr, ...) can have its own with no locking
+
+    range(n) is 0 to n-1 with no bias (multiply-shift, a rare retry
+    instead of %, no divide needed in the normal case)
+
+    Rng rng{ 1234 };
+    auto v = rng.next();            //u32
+    auto d = rng.between( 1, 6 );   //1-6
+    rng.fill( buf, sizeof buf );
+
+    no includes, only needs the u8/u16/u32/u64 types (MyStm32.hpp), so
+    it can also be used by the host test in tests/
+
+    xoshiro128** from-
+https://prng.di.unimi.it/
+-----------------------------------------------------------------------------*/
+class Rng {
+
+//-------------|
+    private:
+//-------------|
+
+                u32 s_[4]{};
+
+                static u32
+rotl            (u32 v, int n) { return (v<<n) bitor (v>>(32-n)); }
+
+//-------------|
+    public:
+//-------------|
+
+                constexpr
+Rng             () = default; //not seeded, seed() before use
+
+Rng             (u32 v) { seed( v ); }
+
+                //set the state directly (reference sequences), not all 0
+                auto
+state           (u32 a, u32 b, u32 c, u32 d) -> void { s_[0] = a; s_[1] = b; s_[2] = c; s_[3] = d; }
+
+                //any value ok, state filled from splitmix32 (never all 0)
+                auto
+seed            (u32 v) -> void
+                {
+                for( auto& s : s_ ){
+                    u32 z = (v += 0x9E3779B9);
+                    z = (z xor (z>>16)) * 0x85EBCA6B;
+                    z = (z xor (z>>13)) * 0xC2B2AE35;
+                    s = z xor (z>>16);
+                    }
+                if( not isSeeded() ) s_[0] = 1;
+                }
+
+                auto
+isSeeded        () -> bool { return (s_[0] bitor s_[1] bitor s_[2] bitor s_[3]) != 0; }
+
+                u32
+next            ()
+                {
+                u32 r = rotl( s_[1]*5, 7 ) * 9;
+                u32 t = s_[1]<<9;
+                s_[2] xor_eq s_[0];
+                s_[3] xor_eq s_[1];
+                s_[1] xor_eq s_[2];
+                s_[0] xor_eq s_[3];
+                s_[2] xor_eq t;
+                s_[3] = rotl( s_[3], 11 );
+                return r;
+                }
+
+                auto
+next16          () { return (u16)(next()>>16); } //upper bits are better
+                auto
+next64          () { return ((u64)next()<<32) bitor next(); }
+
+                //0 to n-1 (0 if n is 0)
+                u32
+range           (u32 n)
+                {
+                u64 m = (u64)next() * n;
+                if( (u32)m < n ){
+                    u32 t = -n % n; //2^32 % n
+                    while( (u32)m < t ) m = (u64)next() * n;
+                    }
+                return m>>32;
+                }
+
+                //min to max inclusive
+                auto
+between         (u32 min, u32 max)
+                {
+                return max - min == 0xFFFFFFFF ? next() : min + range( max - min + 1 );
+                }
+
+                auto
+fill            (u8* buf, u32 n)
+                {
+                for( ; n >= 4; n -= 4 ){
+                    u32 v = next();
+                    *buf++ = v; *buf++ = v>>8; *buf++ = v>>16; *buf++ = v>>24;
+                    }
+                if( n ){ u32 v = next(); while( n-- ){ *buf++ = v; v >>= 8; } }
+                }
+                auto
+fill            (u32* buf, u32 n) { while( n-- ) *buf++ = next(); }
+
+};
+
+} //namespace UTIL
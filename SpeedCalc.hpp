@@ -0,0 +1,85 @@
+#pragma once //SpeedCalc.hpp
+
+/*-----------------------------------------------------------------------------
+    SpeedCalc - M/T method velocity and acceleration math, used by
+    EncoderSpeed::tick() (see Encoder.hpp)
+
+    update() takes the edge count and time of the last edge (as captured
+    by the encoder isr) and the time now, in us from a free running timer
+    of mask+1 range, and returns velocity and acceleration in Q24.8
+    (counts/sec, counts/sec^2)
+
+    no includes, only needs the i32/u32/i64 types (MyStm32.hpp), so it
+    can also be used by the host test in tests/
+-----------------------------------------------------------------------------*/
+class SpeedCalc {
+
+//-------------|
+    public:
+//-------------|
+
+                struct Result { i32 velocity, acceleration; };
+
+//-------------|
+    private:
+//-------------|
+
+                u32 mask_;                  //timer counter size
+                u32 timeout_;               //us
+                u32 tEdgePrev_;
+                i32 edgesPrev_{0};
+                u32 tTick_;
+                i32 vel_{0};                //Q24.8 counts/sec
+
+                static i32
+saturate        (i64 v) { return v > 0x7FFFFFFF ? 0x7FFFFFFF : v < -0x7FFFFFFF ? -0x7FFFFFFF : (i32)v; }
+
+                //n counts per dt us -> Q24.8 counts/sec (saturated)
+                static i32
+rate            (i32 n, u32 dtUs)
+                {
+                if( dtUs == 0 ) dtUs = 1;
+                return saturate( (i64)n * (1000000<<8) / dtUs );
+                }
+
+                //Q24.8 change per dt us -> Q24.8 per sec (already Q24.8, so no <<8)
+                static i32
+rateQ8          (i32 dq, u32 dtUs)
+                {
+                if( dtUs == 0 ) dtUs = 1;
+                return saturate( (i64)dq * 1000000 / dtUs );
+                }
+
+//-------------|
+    public:
+//-------------|
+
+SpeedCalc       (u32 mask, u32 timeoutUs, u32 tnow)
+                : mask_( mask ), timeout_( timeoutUs ), tEdgePrev_( tnow ), tTick_( tnow ) {}
+
+                //edges- edge count, tEdge- time of the last edge, tnow- time now
+                Result
+update          (i32 edges, u32 tEdge, u32 tnow)
+                {
+                auto m = edges - edgesPrev_;
+                i32 v;
+                if( m ){
+                    v = rate( m, (tEdge - tEdgePrev_) bitand mask_ );
+                    tEdgePrev_ = tEdge;
+                    edgesPrev_ = edges;
+                    }
+                else {
+                    u32 dt = (tnow - tEdgePrev_) bitand mask_;
+                    if( dt >= timeout_ ) v = 0;
+                    else { //no faster than 1 count since last edge, same direction
+                        auto vmax = rate( 1, dt );
+                        v = vel_ > vmax ? vmax : vel_ < -vmax ? -vmax : vel_;
+                        }
+                    }
+                auto a = rateQ8( v - vel_, (tnow - tTick_) bitand mask_ );
+                tTick_ = tnow;
+                vel_ = v;
+                return { v, a };
+                }
+
+};
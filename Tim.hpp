@@ -0,0 +1,119 @@
+#pragma once //Tim.hpp
+
+#include "MyStm32.hpp"
+
+/*=============================================================
+    RccTim - RCC functions for TIM1/2/3/14/16/17
+=============================================================*/
+class RccTim {
+
+    protected:
+
+                //apb enable register and bit for a timer
+                static auto
+rccBit          (TIM_TypeDef* t)
+                {
+                struct { volatile u32& reg; u32 bm; } r =
+                    t == TIM2  ? decltype(r){ RCC->APBENR1, RCC_APBENR1_TIM2EN } :
+                    t == TIM3  ? decltype(r){ RCC->APBENR1, RCC_APBENR1_TIM3EN } :
+                    t == TIM1  ? decltype(r){ RCC->APBENR2, RCC_APBENR2_TIM1EN } :
+                    t == TIM14 ? decltype(r){ RCC->APBENR2, RCC_APBENR2_TIM14EN } :
+                    t == TIM16 ? decltype(r){ RCC->APBENR2, RCC_APBENR2_TIM16EN } :
+                                 decltype(r){ RCC->APBENR2, RCC_APBENR2_TIM17EN };
+                return r;
+                }
+
+                auto
+enable          (TIM_TypeDef* t) { auto r = rccBit(t); r.reg or_eq r.bm; }
+                auto
+disable         (TIM_TypeDef* t) { auto r = rccBit(t); r.reg and_eq compl r.bm; }
+                auto //reset register bits are in the same positions as the enable bits
+reset           (TIM_TypeDef* t)
+                {
+                auto r = rccBit(t);
+                auto& rst = &r.reg == &RCC->APBENR1 ? RCC->APBRSTR1 : RCC->APBRSTR2;
+                rst or_eq r.bm;
+                rst and_eq compl r.bm;
+                }
+};
+
+/*=============================================================
+    Tim - general purpose timer, basic up counting use only
+    (a time base for other things like dma pacing, timestamps)
+    uses timT from our mcu header
+=============================================================*/
+struct Tim : RccTim {
+
+//-------------|
+    private:
+//-------------|
+
+                TIM_TypeDef& reg_;
+
+//-------------|
+    public:
+//-------------|
+
+                const u8 dmaUp;     //dmamux request id for update event
+                const bool is32;    //TIM2 is 32bit
+
+Tim             (timT t)
+                : reg_(*t.tim), dmaUp(t.dmaUp), is32(t.tim == TIM2)
+                {
+                RccTim::reset( t.tim );
+                RccTim::enable( t.tim );
+                }
+
+                auto&
+reg             () { return reg_; }
+
+                auto
+on              () { reg_.CR1 or_eq TIM_CR1_CEN; return *this; }
+                auto
+off             () { reg_.CR1 and_eq compl TIM_CR1_CEN; return *this; }
+
+                //prescaler and reload, loaded now (update event generated)
+                auto
+setPeriod       (u16 psc, u32 arr)
+                {
+                reg_.PSC = psc;
+                reg_.ARR = arr;
+                reg_.EGR = TIM_EGR_UG;
+                reg_.SR = 0;            //clear UIF from the UG
+                return *this;
+                }
+
+                //update event rate in Hz (from cpu clock), prescaler used only if needed
+                //(16bit timers- rates under ~250Hz at 16MHz will need a prescaler),
+                //clamped to 1Hz to cpu clock/2 (an ARR of 0 stops the counter)
+                auto
+setRate         (u32 hz)
+                {
+                u32 clk = System::cpuMHz*1000000ul;
+                if( hz < 1 ) hz = 1;
+                if( hz > clk/2 ) hz = clk/2;
+                u32 ticks = clk/hz;
+                u32 psc = is32 ? 0 : ticks>>16;
+                return setPeriod( psc, ticks/(psc+1) - 1 );
+                }
+
+                //count at a fixed tick rate (Hz), free running full range, clamped
+                //to cpu clock/65536 (16bit prescaler) to cpu clock
+                auto
+freeRun         (u32 hz)
+                {
+                u32 clk = System::cpuMHz*1000000ul;
+                if( hz > clk ) hz = clk;
+                if( hz < (clk + 0xFFFF)/0x10000 ) hz = (clk + 0xFFFF)/0x10000;
+                return setPeriod( clk/hz - 1, is32 ? 0xFFFFFFFF : 0xFFFF ).on();
+                }
+
+                auto
+dmaUpdateOn     () { reg_.DIER or_eq TIM_DIER_UDE; return *this; }
+                auto
+dmaUpdateOff    () { reg_.DIER and_eq compl TIM_DIER_UDE; return *this; }
+
+                auto
+count           () { return reg_.CNT; }
+
+};
@@ -0,0 +1,148 @@
+#pragma once //TimerWheel.hpp
+
+/*-----------------------------------------------------------------------------
+    TimerWheel - timing wheel of user supplied timer nodes, the list and
+    time keeping part of LptimTimers (see Lptim.hpp)
+
+    a list per time slot plus a bitmap of slots in use, add/remove are
+    O(1), run() calls the functions of the timers that are due, next()
+    finds the earliest deadline- times are in ticks, compared as a
+    signed difference
+
+    a timer function may start or cancel any timer (itself, or another
+    in the slot being run)- the slot list being run is moved to pending_,
+    a proper list like the slots, so a remove of a timer not yet run
+    unlinks it from there, and pending_ is re-read after each function
+
+    no includes, only needs the u32/i32 types (MyStm32.hpp) and ctz
+    (Util.hpp), so it can also be used by the host test in tests/
+-----------------------------------------------------------------------------*/
+class TimerWheel {
+
+//-------------|
+    public:
+//-------------|
+
+                struct Timer {
+                    void(*func)();
+                    u32 period{0};          //0 = one-shot
+                    u32 deadline{0};
+                    Timer* next{nullptr};
+                    Timer** pprev{nullptr}; //nullptr when not active
+                    };
+
+                static constexpr u32 SLOTS  { 32 };     //bitmap is u32
+                static constexpr u32 SHIFT  { 10 };     //slot is 1024 ticks
+
+//-------------|
+    private:
+//-------------|
+
+                Timer* slots_[SLOTS]{};
+                u32 map_{0};                //slots in use
+                Timer* pending_{nullptr};   //slot list being run
+                u32 curSlot_{0};            //last slot run (absolute)
+
+                static u32
+index           (u32 deadline) { return (deadline>>SHIFT) bitand (SLOTS-1); }
+
+                //insert at the head of the list at *head
+                static void
+push            (Timer*& head, Timer& t)
+                {
+                t.next = head;
+                if( t.next ) t.next->pprev = &t.next;
+                t.pprev = &head;
+                head = &t;
+                }
+
+                auto
+link            (Timer& t)
+                {
+                auto idx = index( t.deadline );
+                push( slots_[idx], t );
+                map_ or_eq 1<<idx;
+                }
+
+                //from a slot, or from pending_ (that slot is already clear in map_,
+                //or has timers relinked to it so stays set)
+                auto
+unlink          (Timer& t)
+                {
+                *t.pprev = t.next;
+                if( t.next ) t.next->pprev = t.pprev;
+                t.pprev = nullptr;
+                t.next = nullptr;
+                auto idx = index( t.deadline );
+                if( not slots_[idx] ) map_ and_eq compl (1<<idx);
+                }
+
+                //run the due timers of one slot, relink the rest
+                auto
+runSlot         (u32 idx, u32 now)
+                {
+                if( not slots_[idx] ) return;
+                pending_ = slots_[idx];         //take the list
+                pending_->pprev = &pending_;
+                slots_[idx] = nullptr;
+                map_ and_eq compl (1<<idx);
+                while( auto t = pending_ ){     //re-read, a function may remove any
+                    unlink( *t );
+                    if( (i32)(t->deadline - now) > 0 ) link( *t );
+                    else {
+                        if( t->period ){ t->deadline += t->period; link( *t ); }
+                        t->func(); //may start/cancel itself or any other timer
+                        }
+                    }
+                }
+
+//-------------|
+    public:
+//-------------|
+
+                //start from now (no slots before this one are run)
+                auto
+init            (u32 now) { curSlot_ = now>>SHIFT; }
+
+                auto
+add             (Timer& t) { link( t ); }
+
+                auto
+remove          (Timer& t) { if( t.pprev ) unlink( t ); }
+
+                static auto
+isActive        (const Timer& t) { return t.pprev != nullptr; }
+
+                //run due timers in all slots passed since the last run (one
+                //turn of the wheel at most)
+                auto
+run             (u32 now)
+                {
+                u32 nowSlot = now>>SHIFT;
+                u32 n = nowSlot - curSlot_ + 1;
+                if( n > SLOTS ) n = SLOTS;
+                for( u32 s = nowSlot - n + 1; n--; s++ ) runSlot( s bitand (SLOTS-1), now );
+                curSlot_ = nowSlot;
+                }
+
+                //earliest deadline (no later than now + maxWait)- slots in ring
+                //order from now, the first slot with a timer in this turn of the
+                //wheel has the earliest deadline
+                auto
+next            (u32 now, u32 maxWait)
+                {
+                u32 best = now + maxWait;
+                u32 idx = index( now );
+                u32 rot = idx ? (map_>>idx) bitor (map_<<(SLOTS-idx)) : map_;
+                while( rot ){
+                    auto d = ctz( rot );
+                    rot and_eq rot-1;
+                    for( auto t = slots_[(idx+d) bitand (SLOTS-1)]; t; t = t->next ){
+                        if( (i32)(t->deadline - best) < 0 ) best = t->deadline;
+                        }
+                    if( best - now < ((d+1u)<<SHIFT) ) break;
+                    }
+                return best;
+                }
+
+};
@@ -28,6 +28,7 @@ struct Uart : FMT::Print {
                 u8 bufIdxIn_;
                 u8 bufIdxOut_;
                 volatile u8 bufCount_;
+                IRQn_Type irqn_;
 
                 auto //default 16 sample rate
 baudReg         (u32 baud) { reg_.BRR = System::cpuMHz*1000000/baud; }
@@ -71,13 +72,44 @@ write           (const char c)
                 while( bufCount_ >= bufSiz_ ){} //if buffer full, wait for txe isr to make room in buffer
                 buf_[bufIdxIn_] = c;
                 if( ++bufIdxIn_ >= bufSiz_ ) bufIdxIn_ = 0;
-                { InterruptLock lock; bufCount_++; } //protect increment
+                { IrqLock lock{ irqn_ }; bufCount_++; } //protect increment (from our isr)
                 txeIrqOn();
                 return true;
                 }
 
-Uart            (uartT u, u32 baud, u8* buffer = 0, u8 bufferSiz = 0)
-                : reg_(*u.uart)
+                //span version, copy as much as will fit into the buffer before
+                //each (single) protected count update
+                virtual int
+write           (const char* str, int n)
+                {
+                if( not buf_ ){
+                    auto cnt = 0;
+                    while( n-- > 0 ) if( write(*str++) ) cnt++;
+                    return cnt;
+                    }
+                auto cnt = n;
+                while( n > 0 ){
+                    while( bufCount_ >= bufSiz_ ){} //if buffer full, wait for txe isr to make room in buffer
+                    int room = bufSiz_ - bufCount_; //isr only makes more room
+                    auto m = n < room ? n : room;
+                    for( auto i = 0; i < m; i++ ){
+                        buf_[bufIdxIn_] = *str++;
+                        if( ++bufIdxIn_ >= bufSiz_ ) bufIdxIn_ = 0;
+                        }
+                    { IrqLock lock{ irqn_ }; bufCount_ += m; } //protect add
+                    txeIrqOn();
+                    n -= m;
+                    }
+                return cnt;
+                }
+
+                //nothing buffered and last byte shifted out
+                auto
+isIdle          () { return bufCount_ == 0 and (reg_.ISR bitand USART_ISR_TC); }
+
+                //pinInit false if the tx pin is in a PinMap table (board.pins)
+Uart            (uartT u, u32 baud, u8* buffer = 0, u8 bufferSiz = 0, bool pinInit = true)
+                : reg_(*u.uart), irqn_(u.uart == USART1 ? USART1_IRQn : USART2_IRQn)
                 {
                 if( u.uart == USART1 ){
                     instances_[0] = this;
@@ -88,9 +120,9 @@ Uart            (uartT u, u32 baud, u8* buffer = 0, u8 bufferSiz = 0)
                     RCC->APBENR1 or_eq RCC_APBENR1_USART2EN_Msk;
                     }
                 //first set default state when tx not enabled (input/pullup)
-                GpioPin(u.txPin).mode(PINS::INPUT).pull(PINS::PULLUP).altFunc(u.txAltFunc);
+                if( pinInit ) GpioPin(u.txPin).mode(PINS::INPUT).pull(PINS::PULLUP).altFunc(u.txAltFunc);
                 baudReg( baud );
-                irqFunction( u.uart == USART1 ? USART1_IRQn : USART2_IRQn, isr );
+                irqFunction( irqn_, isr );
                 buf_ = buffer;
                 bufSiz_ = bufferSiz;
                 txOn();
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "MyStm32.hpp"
+#include "Rng.hpp"
 
 //things that need to be outside of UTIL namespace
 extern void* _sstack; //used in random16
@@ -21,21 +22,111 @@ extern vectorFuncT _sramvector[16+LPUART1_IRQn+1];
 -----------------------------------------------------------------------------*/
 namespace UTIL {
 
+/*-----------------------------------------------------------------------------
+    IrqLock - mask only the irqs at or below a priority level
+
+    the M0+ has 4 priority levels (0 highest, 3 lowest) and no BASEPRI,
+    so InterruptLock (PRIMASK) blocks every irq- IrqLock instead disables
+    (NVIC->ICER) the enabled irqs with a priority level at or below the
+    one given, then re-enables (NVIC->ISER) only those at end of scope,
+    so higher priority irqs still run
+
+    the lock level is normally that of the irq sharing the data-
+        { IrqLock lock{ USART1_IRQn }; bufCount_++; }
+
+    irq levels are tracked by irqPriority() (all irqs start at level 0,
+    so until priorities are set an IrqLock masks all peripheral irqs),
+    SysTick and other exceptions are not masked
+
+    a higher priority irq should not enable/disable a masked irq while
+    locked (it will be enabled again at the end of the lock)
+-----------------------------------------------------------------------------*/
+class IrqLock {
+
+//-------------|
+    private:
+//-------------|
+
+                static inline u32 levelMask_[4]{ 0xFFFFFFFF }; //irqs at each level
+                u32 saved_;
+
+                static u32
+atOrBelow       (u8 level)
+                {
+                u32 m = 0;
+                for( ; level < 4; level++ ) m or_eq levelMask_[level];
+                return m;
+                }
+
+//-------------|
+    public:
+//-------------|
+
+                //peripheral irqs only (n >= 0), level 0-3
+                static void
+priority        (IRQn_Type n, u8 level)
+                {
+                if( n < 0 ) return NVIC_SetPriority( n, level );
+                level and_eq 3;
+                u32 bm = 1ul<<n;
+                for( auto& m : levelMask_ ) m and_eq compl bm;
+                levelMask_[level] or_eq bm;
+                NVIC_SetPriority( n, level );
+                }
+
+IrqLock         (u8 level)
+                {
+                auto pm = __get_PRIMASK(); //read/clear as one
+                __disable_irq();
+                saved_ = NVIC->ISER[0] bitand atOrBelow( level );
+                NVIC->ICER[0] = saved_;
+                __DSB();                    //mask in effect before irqs back on,
+                __ISB();                    //so a masked irq cannot slip in
+                __set_PRIMASK( pm );
+                }
+
+                //at the level of this irq
+IrqLock         (IRQn_Type n) : IrqLock( (u8)NVIC_GetPriority(n) ) {}
+
+~IrqLock        () { NVIC->ISER[0] = saved_; }
+
+};
+
+                //set priority level of an irq (0 highest, 3 lowest)
+                inline auto
+irqPriority     (IRQn_Type n, u8 level) { IrqLock::priority( n, level ); }
+
+                inline auto
+irqPriority     (IRQn_Type n) { return (u8)NVIC_GetPriority( n ); }
+
+
 /*-----------------------------------------------------------------------------
     irqFunction() - set interrupt function in ram vector table
     function addresses already have bit0 set
     table offset [16] is for peripheral 0, so using [16+n]
     optionally enable the nvic irq for the function (default), or if want
         to enable on your own, use 'false' for the third argument
+    optionally set the priority level (0-3), left as-is by default
 
     irqDelete() - set to default interrupt handler, disable NVIC irq
 
     no other options for enable/disable, but can do on your own
     these simply provide a function entry into the table, or remove it
+
+    with IRQ_STATS_ENABLE 1, peripheral irq functions (n >= 0) are
+    called through a trampoline which collects stats (see IrqStats)
 -----------------------------------------------------------------------------*/
+#ifndef IRQ_STATS_ENABLE
+#define IRQ_STATS_ENABLE 0
+#endif
+                inline vectorFuncT
+irqTrampoline   (IRQn_Type n, vectorFuncT f); //IrqStats, below
+
                 inline auto
-irqFunction     (IRQn_Type n, vectorFuncT f, bool enable = true)
+irqFunction     (IRQn_Type n, vectorFuncT f, bool enable = true, u8 priority = 0xFF)
                 {
+                if( priority != 0xFF ) irqPriority( n, priority );
+                if constexpr( IRQ_STATS_ENABLE ) if( n >= 0 ) f = irqTrampoline( n, f );
                 _sramvector[16+n] = f;
                 if( enable ) NVIC_EnableIRQ(n); //it will check for >= 0
                 }
@@ -93,6 +184,60 @@ InterruptLock   ()
 };
 
 
+/*-----------------------------------------------------------------------------
+    ReadDelta - consume an isr updated counter without disabling interrupts
+
+    the M0+ has no ldrex/strex, so a read-then-clear of a counter the isr
+    also writes needs an InterruptLock- instead, the isr only ever adds to
+    the counter (letting it wrap), and each reader keeps its own watermark
+    of what it has already consumed, the difference (unsigned, so wrap is
+    handled) is what is new since the last read
+
+    requirements-
+        counter is 32bits or less (single load is atomic)
+        isr only adds/subtracts, nothing else writes the counter
+        read often enough that the difference cannot exceed the type range
+
+    any number of readers, each with its own ReadDelta
+
+    volatile u32 pulses; //isr: pulses = pulses + 1;
+    ReadDelta<u32> rd{ pulses };
+    auto n = rd.read();  //new pulses since last read
+
+    for counters wider than the atomic size (LptimExtCounter- the isr only
+    increments pulseCountH_, the hardware increments CNT), read the parts
+    and reread until the parts are consistent instead of locking
+-----------------------------------------------------------------------------*/
+                template<typename T>
+class ReadDelta {
+
+//-------------|
+    public:
+//-------------|
+
+ReadDelta       (const volatile T& src) : src_(src), base_(src) {}
+
+                //new since last read (nothing consumed)
+                auto
+count           () { return T(src_ - base_); }
+
+                //new since last read, consume
+                auto
+read            () { T v = src_; T r = v - base_; base_ = v; return r; }
+
+                auto
+reset           () { base_ = src_; }
+
+//-------------|
+    private:
+//-------------|
+
+                const volatile T& src_;
+                T base_;
+
+};
+
+
 /*-----------------------------------------------------------------------------
     get size of an array
     u32 a[16];
@@ -104,52 +249,72 @@ arraySize       (T (&v)[N]) { (void)v; return N; }
 
 
 /*-----------------------------------------------------------------------------
-    get a random 16 bit number, also a version with min/max
+    count trailing zeros (bit number of lowest set bit), v cannot be 0
+    the M0+ has no clz/ctz instructions and __builtin_ctz ends up as a
+    libgcc call, so use a de Bruijn multiply and table lookup instead
 
-    poly values and idea from-
-https://www.maximintegrated.com/en/design/technical-documents/app-notes/4/4400.html
+    while( bm ){ auto n = ctz(bm); bm and_eq bm-1; ... } //each set bit
 -----------------------------------------------------------------------------*/
-                inline u16
-random16        ()
+                inline u8
+ctz             (u32 v)
                 {
-                auto shift = [] (u32& v, u32 mask) { //local function
-                    auto bit0 = v bitand 1;
-                    v >>= 1;
-                    return bit0 ? v xor_eq mask : v;
+                static constexpr u8 tbl[32]{
+                    0,1,28,2,29,14,24,3,30,22,20,15,25,17,4,8,
+                    31,27,13,23,21,19,16,7,26,12,18,6,11,5,10,9
                     };
-                #define POLY_MASK32 0xB4BCD35C
-                #define POLY_MASK31 0x7A5BC2E3
-                static u32 lfsr32, lfsr31;
-                if( lfsr32 == 0 ) { //init on first use
-                    u32* pRam = (u32*)&_sstack;
-                    lfsr32 = pRam[0] bitor 1; //cannot be 0, so set a bit
-                    lfsr31 = pRam[1] bitor 1; //  to make sure
-                    }
-                shift(lfsr32, POLY_MASK32); //this one done 2x
-                return shift(lfsr32, POLY_MASK32) xor shift(lfsr31, POLY_MASK31);
-                #undef POLY_MASK32
-                #undef POLY_MASK31
+                return tbl[((v bitand -v) * 0x077CB531u)>>27];
                 }
 
-                inline u32
-random32        () { return ((u32)random16()<<16) + random16(); }
 
-                inline u64
-random64        () { return ((u64)random32()<<32) + random32(); }
+/*-----------------------------------------------------------------------------
+    Rng - xoshiro128** random number generator (Rng.hpp)
+
+    get a random 16 bit number, also a version with min/max
+
+    uses a shared Rng, seeded at startup from hardware noise if
+    Entropy.hpp is included, else seeded on first use from ram contents
+    at the stack bottom (random at power up), the shared state is updated
+    with interrupts off so can be used from main and isr's (use an
+    Rng object instead if that is a concern)
+-----------------------------------------------------------------------------*/
+                inline Rng rng;
 
-                //rand() % (max_number + 1 - minimum_number) + minimum_number
+                inline u32
+random32        ()
+                {
+                InterruptLock lock;
+                if( not rng.isSeeded() ) { //init on first use
+                    u32* pRam = (u32*)&_sstack;
+                    rng.seed( pRam[0] xor (pRam[1]<<1) );
+                    }
+                return rng.next();
+                }
 
                 inline u16
-random16        (u16 min, u16 max)
-                { return random16() % (max + 1 - min) + min; }
+random16        () { return random32()>>16; }
 
+                inline u64
+random64        () { return ((u64)random32()<<32) bitor random32(); }
+
+                //min to max inclusive, no bias (see Rng::range)
                 inline u32
 random32        (u32 min, u32 max)
-                { return random32() % (max + 1 - min) + min; }
+                {
+                if( max - min == 0xFFFFFFFF ) return random32();
+                auto n = max - min + 1;
+                u64 m = (u64)random32() * n;
+                if( (u32)m < n ){
+                    u32 t = -n % n;
+                    while( (u32)m < t ) m = (u64)random32() * n;
+                    }
+                return min + (m>>32);
+                }
+
+                inline u16
+random16        (u16 min, u16 max) { return random32( min, max ); }
 
                 inline u64
-random64        (u32 min, u32 max)
-                { return random64() % (max + 1 - min) + min; }
+random64        (u32 min, u32 max) { return random32( min, max ); }
 
 /*-----------------------------------------------------------------------------
     swap two vars of the same type
@@ -167,14 +332,277 @@ swap            (T& a, T& b) { T c(a); a=b; b=c; }
 shuffle         (T (&arr)[N])
                 {
                 for( auto i = N-1; i > 0; i-- ) {
-                    u8 r = random16(0,i);
+                    auto r = random32(0,i);
                     swap( arr[i], arr[r] );
                     }
                 }
 
+                //using an Rng object
+                template<typename T, int N>
+                SCA
+shuffle         (T (&arr)[N], Rng& rng)
+                {
+                for( auto i = N-1; i > 0; i-- ) {
+                    auto r = rng.range(i+1);
+                    swap( arr[i], arr[r] );
+                    }
+                }
+
+
+/*-----------------------------------------------------------------------------
+    wait for an interrupt in a low power mode
+    stop = false - sleep mode, all peripheral clocks keep running
+    stop = true  - stop1 mode, only lsi/lse clocked peripherals (lptim, etc.)
+                   keep running, wakeup via exti line (lptim is exti 29/30,
+                   enabled by default), HSI16 is system clock after wakeup
+                   (swd connection is lost unless DBG->CR DBG_STOP is set)
+-----------------------------------------------------------------------------*/
+                inline auto
+idle            (bool stop)
+                {
+                if( stop ){
+                    RCC->APBENR1 or_eq RCC_APBENR1_PWREN;
+                    PWR->CR1 = (PWR->CR1 bitand compl PWR_CR1_LPMS) bitor PWR_CR1_LPMS_0; //stop1
+                    SCB->SCR or_eq SCB_SCR_SLEEPDEEP_Msk;
+                    }
+                __DSB();
+                __WFI();
+                SCB->SCR and_eq compl SCB_SCR_SLEEPDEEP_Msk;
+                }
+
+
+/*-----------------------------------------------------------------------------
+    Systick - SysTick as a 1ms interrupt time base, the counter value
+    gives the time within the ms (cpu clock resolution)
+
+    off unless started- call init() (from preinit() if constructors
+    need it, else from main), and again if the cpu clock is changed
+    (System::cpuMHz), stop() to turn off
+
+    the 1ms irq wakes the cpu from sleep every ms, so leave it off (or
+    stop() it first) for a tickless sleep (LptimTimers::sleepUntil)- it
+    does not count in stop mode, so ms/us/cycles are not valid across
+    an idle(true), and do not advance at all when off- the blocking
+    delays and Deadline use a loop when off
+
+    ms() - 32bit ms count (~49 days)
+    us() - 32bit us count (~71 minutes), compare as a difference
+    cycles() - 32bit cpu cycle count, for profiling (see Profile.hpp)
+    delayCycles/US/MS - count cpu cycles so accurate at any clock or
+        optimization level, and work with interrupts off (an isr only
+        makes the delay longer)
+    Deadline - timeout from now, non-blocking checks
+
+    Deadline dl{ 500 }; //500us
+    while( not (reg bitand FLAG) ){ if( dl.expired() ) return false; }
+-----------------------------------------------------------------------------*/
+class Systick {
+
+//-------------|
+    private:
+//-------------|
+
+                static inline volatile u32 ms_;
+
+                static void
+isr             () { ms_ = ms_ + 1; }
+
+//-------------|
+    public:
+//-------------|
+
+                static void
+init            ()
+                {
+                SysTick->CTRL = 0;
+                SysTick->LOAD = System::cpuMHz*1000ul - 1;
+                SysTick->VAL = 0;
+                irqFunction( SysTick_IRQn, isr );
+                SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk bitor SysTick_CTRL_TICKINT_Msk
+                                bitor SysTick_CTRL_ENABLE_Msk;
+                }
+
+                static void
+stop            () { SysTick->CTRL = 0; }
+
+                static bool
+isOn            () { return SysTick->CTRL bitand SysTick_CTRL_ENABLE_Msk; }
+
+                static u32
+ms              () { return ms_; }
+
+                //a reload not yet seen by the isr (interrupts off, or in a
+                //higher priority isr) is also handled
+                static u32
+us              ()
+                {
+                u32 m, v; bool p;
+                do{
+                    m = ms_;
+                    v = SysTick->VAL;
+                    p = SCB->ICSR bitand SCB_ICSR_PENDSTSET_Msk;
+                    } while( m != ms_ );
+                u32 top = SysTick->LOAD;
+                if( p and v > top/2 ) m++; //reloaded after the pending bit set
+                return m*1000 + (top - v)/System::cpuMHz;
+                }
+
+                //cpu cycle count (wraps, ~268 sec at 16MHz), compare as a difference
+                static u32
+cycles          ()
+                {
+                u32 m, v; bool p;
+                do{
+                    m = ms_;
+                    v = SysTick->VAL;
+                    p = SCB->ICSR bitand SCB_ICSR_PENDSTSET_Msk;
+                    } while( m != ms_ );
+                u32 top = SysTick->LOAD;
+                if( p and v > top/2 ) m++;
+                return m*(top+1) + (top - v);
+                }
+
+                //true if us have passed since startUs (from us())
+                static bool
+elapsed         (u32 startUs, u32 us) { return Systick::us() - startUs >= us; }
+
+                static void
+delayCycles     (u32 n)
+                {
+                u32 reload = SysTick->LOAD + 1;
+                u32 last = SysTick->VAL;
+                while( true ){
+                    u32 now = SysTick->VAL;
+                    u32 d = last >= now ? last - now : last + reload - now; //counts down
+                    if( d >= n ) return;
+                    n -= d;
+                    last = now;
+                    }
+                }
+
+                static void
+delayUS         (u32 us) { while( us > 100000 ){ delayCycles( System::cpuMHz*100000ul ); us -= 100000; }
+                           delayCycles( System::cpuMHz*us ); }
+
+                static void
+delayMS         (u32 ms) { while( ms-- ) delayCycles( System::cpuMHz*1000ul ); }
+
+};
+
+
+/*-----------------------------------------------------------------------------
+    IrqStats - per irq entry count and time, and cpu load
+
+    IRQ_STATS_ENABLE 1 (before any include, or -DIRQ_STATS_ENABLE=1)
+    and irqFunction puts a trampoline in the ram vector table for
+    peripheral irqs, the trampoline calls the irq function and adds
+    its time in cycles (Systick::cycles) to the stats for that irq
+
+    time for an irq includes any higher priority irq nested in it,
+    busy time counts from the first irq entry until no irq is active,
+    so load is the time spent in any irq since reset() (cycle counts
+    are 32bits, ~268sec at 16MHz, so reset() more often than that)
+
+    SysTick (and other exceptions) are not included, and Systick
+    must be started (Systick::init)
+
+    IrqStats::report( uart ); //any Print (or anything with <<)
+    auto pct = IrqStats::loadPct();
+-----------------------------------------------------------------------------*/
+class IrqStats {
+
+//-------------|
+    public:
+//-------------|
+
+                SCA IRQS{ LPUART1_IRQn+1 };
+
+                struct Stat { u32 count; u32 cycles; u32 max; };
+
+//-------------|
+    private:
+//-------------|
+
+                static inline vectorFuncT handlers_[IRQS];
+                static inline Stat stats_[IRQS];
+                static inline u8 nest_;
+                static inline u32 busyStart_;
+                static inline u32 busy_;
+                static inline u32 start_; //of the stats period
+
+                static void
+trampoline      ()
+                {
+                auto n = irqActive();
+                u32 t; //entry and exit locked, nest_ is shared with nested irqs
+                { InterruptLock lock; t = Systick::cycles(); if( nest_++ == 0 ) busyStart_ = t; }
+                handlers_[n]();
+                InterruptLock lock; //a nested irq would otherwise be lost
+                u32 now = Systick::cycles();
+                auto& s = stats_[n];
+                s.count++;
+                s.cycles += now - t;
+                if( now - t > s.max ) s.max = now - t;
+                if( --nest_ == 0 ) busy_ += now - busyStart_;
+                }
+
+//-------------|
+    public:
+//-------------|
+
+                static vectorFuncT
+install         (IRQn_Type n, vectorFuncT f)
+                {
+                handlers_[n] = f;
+                return trampoline;
+                }
+
+                static Stat
+stat            (IRQn_Type n) { InterruptLock lock; return stats_[n]; }
+
+                //percent x10 (0-1000)
+                static u32
+loadPct         ()
+                {
+                InterruptLock lock;
+                u32 period = Systick::cycles() - start_;
+                return period ? (u64)busy_*1000/period : 0;
+                }
+
+                static void
+reset           ()
+                {
+                InterruptLock lock;
+                for( auto& s : stats_ ) s = {};
+                busy_ = 0;
+                start_ = Systick::cycles();
+                if( nest_ ) busyStart_ = start_; //in an irq
+                }
+
+                //irq count cycles mean max, irq's with a count only
+                template<typename P>
+                static void
+report          (P& out)
+                {
+                out << "irq count cycles mean max, load % x10 " << loadPct() << "\r\n";
+                for( u8 i = 0; i < IRQS; i++ ){
+                    auto s = stat( IRQn_Type(i) );
+                    if( not s.count ) continue;
+                    out << i << ' ' << s.count << ' ' << s.cycles << ' '
+                        << s.cycles/s.count << ' ' << s.max << "\r\n";
+                    }
+                }
+
+};
+
+                inline vectorFuncT
+irqTrampoline   (IRQn_Type n, vectorFuncT f) { return IrqStats::install( n, f ); }
+
 
 /*-----------------------------------------------------------------------------
     simple blocking delays
+    Systick used when running (Systick::init), else a calibrated loop
+    (the loop count assumes -Os, an isr makes the delay longer)
 -----------------------------------------------------------------------------*/
                 #pragma GCC push_options
                 #pragma GCC optimize ("-Os")
@@ -182,13 +610,66 @@ shuffle         (T (&arr)[N])
                 //simple blocking inline delays
                 #define CYCLES_PER_LOOP 4
                 II static void
-delayCycles     (volatile u32 n){ while( n -= CYCLES_PER_LOOP, n >= CYCLES_PER_LOOP ){} }
+delayCycles     (volatile u32 n)
+                {
+                if( Systick::isOn() ) return Systick::delayCycles( n );
+                while( n -= CYCLES_PER_LOOP, n >= CYCLES_PER_LOOP ){}
+                }
                 II static void
-delayUS         (u32 us){ delayCycles(System::cpuMHz*us); }
+delayUS         (u32 us)
+                {
+                if( Systick::isOn() ) return Systick::delayUS( us );
+                delayCycles(System::cpuMHz*us);
+                }
                 II static void
 delayMS         (u16 ms){ delayUS( ms*1000 ); }
 
                 #pragma GCC pop_options
                 #undef CYCLES_PER_LOOP
 
+
+/*-----------------------------------------------------------------------------
+    Deadline - timeout in us from creation (or restart), uses Systick
+    when running (Systick::init), else each elapsed() (expired,
+    remaining) is a POLL_US loop delay counted as time passed- so a
+    wait still ends, no sooner than asked (the time of the rest of
+    the poll loop is not counted)
+
+    Deadline dl{ 2000 };
+    while( busy() and not dl.expired() ){}
+-----------------------------------------------------------------------------*/
+class Deadline {
+
+//-------------|
+    private:
+//-------------|
+
+                SCA POLL_US{ 10 };  //Systick off, us per elapsed()
+
+                u32 start_;         //Systick::us(), or us counted when off
+                u32 us_;
+                bool systick_;      //Systick was on at creation/restart
+
+//-------------|
+    public:
+//-------------|
+
+Deadline        (u32 us) : us_( us ) { restart(); }
+
+                void
+restart         () { systick_ = Systick::isOn(); start_ = systick_ ? Systick::us() : 0; }
+                u32
+elapsed         ()
+                {
+                if( systick_ ) return Systick::us() - start_;
+                delayUS( POLL_US );
+                return start_ += POLL_US;
+                }
+                auto
+expired         () { return elapsed() >= us_; }
+                auto
+remaining       () { auto e = elapsed(); return e >= us_ ? 0 : us_ - e; }
+
+};
+
 }
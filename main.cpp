@@ -88,27 +88,88 @@ main            ()
 #endif
 
 
+//Systick time base- Deadline, Profile, IrqStats
+#if 0
+/*-------------------------------------------------------------
+    main
+        instances available fron headers-
+        board
+        uart
+
+    Systick is off unless started, and Profile/IrqStats time with
+    Systick::cycles, so start it first (main, as no constructor
+    needs it)- IrqStats collects with -DIRQ_STATS_ENABLE=1
+
+    print a count, wait (bounded) for the uart to finish, and once
+    a second report the print times and irq stats
+--------------------------------------------------------------*/
+#define PROFILE_ENABLE 1
+#include "Profile.hpp"
+
+                int
+main            ()
+                {
+                Systick::init();
+                IrqStats::reset();
+
+                u32 n = 0;
+                Deadline report{ 1000000 };
+                while( true ) {
+                    { PROFILE( "print" ); uart << "count " << n++ << endl; }
+                    Deadline dl{ 5000 }; //5ms, uart tx done
+                    while( not uart.isIdle() and not dl.expired() ){}
+                    if( not report.expired() ) continue;
+                    report.restart();
+                    Profile::report( uart );
+                    IrqStats::report( uart );
+                    IrqStats::reset();
+                    board.led.toggle();
+                    }
+
+                }
+
+#endif
+
+
 #if 1
 /*-------------------------------------------------------------
     main
 --------------------------------------------------------------*/
 #include "MyStm32.hpp"
 #include "Lptim.hpp"
+#include "Entropy.hpp" //seeds random32() etc. at startup
 
-//count pulses on PB1 ( D[3] )
-LptimExtCounter lptimCounter{ Lptim2_PB1 };
+//count pulses on PB1 ( D[3] ), and measure their frequency (100ms gate on TIM14)
+//(IN1 pin is in appPins below, so not configured by the constructor)
+LptimFreqMeter lptimCounter{ Lptim2_PB1, Tim14, 100, 2000, false };
 
 //need something to generate pulses (board does not provide
 //connections to uart2 or led, so will do this instead)
 //toggle pin in lptim isr function, connect D[2] (this pin)  to D[3] (lptim counter pb1)
-GpioPin pulseGen{ GpioPin(board.D[2]).mode(OUTPUT).off() };
+static constexpr GpioPinT<board.D[2]> pulseGen{ false };
+
+//app pins, configured before any constructors run
+static constexpr PinCfg appPins[]{
+    { board.D[2], OUTPUT },                     //pulseGen, low
+    { Lptim2_PB1.in1, ALTERNATE, PULLDOWN, Lptim2_PB1.in1AltFunc }, //lptimCounter IN1
+    };
+
+                //called by startup after boardInit, before any constructors
+                void
+preinit         ()
+                {
+                PinMap<appPins>::apply();
+                Entropy::seed();
+                }
 
 
 volatile u32 lptimIrqCount; //count lptim irq's, for fun
 
+//software timers and time base on LPTIM1 (pulse counter is using LPTIM2)
+LptimTimers timers{ LPTIM1 };
+
 //blink sos in morse code, 'dit' times are random range of values
-LptimRepeatDo lptim {
-                    LPTIM1, //which timer (pulse counter is using LPTIM2)
+LptimTimers::Timer sos {
                     []{     //lambda function, could move this to a named function also
                         static constexpr bool sos[]{
                             1,0,1,0,1,0, 0,0,0,
@@ -120,11 +181,10 @@ LptimRepeatDo lptim {
                         board.led.on( sos[sosIdx] );
                         if( ++sosIdx >= arraySize(sos) ){
                             sosIdx = 0;
-                            lptim.reinit( random16(80_ms_lptim, 200_ms_lptim) );
+                            timers.start( ::sos, random16(80_ms_lptim, 200_ms_lptim), true );
                             }
                         lptimIrqCount++;
                         }, //end lambda
-                    100_ms_lptim, //start with 100ms
                     };
 
 
@@ -132,6 +192,7 @@ LptimRepeatDo lptim {
                 int
 main            ()
                 {
+                timers.start( sos, 100_ms_lpticks, true ); //start with 100ms
                 while( true ) {
                     //             random32 (hex)  irq count (dec) pulse counts
                     //Hello World [00000000][         0][         0]
@@ -141,8 +202,12 @@ main            ()
                             << FG ORANGE << setwf(10, ' ') << dec << lptimIrqCount
                             << FG ROYAL_BLUE "] lptimCounter.count() ["
                             << FG YELLOW << setw(10) << lptimCounter.count()
+                            << FG ROYAL_BLUE "] mHz ["
+                            << FG YELLOW << setw(10) << lptimCounter.milliHz()
                             << FG ROYAL_BLUE "]" << endl;
-                    delayMS( 10 );
+                    //sleep mode only, the frequency meter gate (TIM14) does not
+                    //run in stop mode (use uart.isIdle() to allow stop mode)
+                    timers.sleepFor( 10_ms_lpticks, []{ return false; } );
                     }
 
                 }
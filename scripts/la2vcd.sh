@@ -0,0 +1,41 @@
+#!/bin/sh
+# la2vcd.sh - convert GpioCapture::send() output to a vcd file
+# usage: la2vcd.sh capture.txt > capture.vcd
+#        (or capture from the serial port: cat /dev/ttyACM0 | la2vcd.sh > capture.vcd)
+
+[ "$1" ] && [ ! -e "$1" ] && { echo "la2vcd: $1 not found" >&2; exit 1; }
+
+awk '
+function hex(s,    i, c, v) {
+    v = 0; s = tolower(s)
+    for( i = 1; i <= length(s); i++ ){
+        c = index("0123456789abcdef", substr(s, i, 1)) - 1
+        if( c < 0 ) break
+        v = v*16 + c
+        }
+    return v
+}
+function bit(v, b) { return int(v / 2^b) % 2 }
+/^LA / { rate = $2; ns = 1000000000 / rate; nch = 0; t = 0; started = 0; next }
+/^CH / { name[nch] = $2; pos[nch] = $3; nch++; next }
+/^END/ { if( started ) printf "#%d\n", t*ns; exit }
+NF == 2 && rate {
+    if( hdr == 0 ){
+        print "$timescale 1ns $end"
+        print "$scope module la $end"
+        for( i = 0; i < nch; i++ ) printf "$var wire 1 %c %s $end\n", 33+i, name[i]
+        print "$upscope $end"
+        print "$enddefinitions $end"
+        hdr = 1
+        }
+    v = hex($1); n = hex($2)
+    printf "#%d\n", t*ns
+    for( i = 0; i < nch; i++ ){
+        b = bit(v, pos[i])
+        if( !started || b != last[i] ) printf "%d%c\n", b, 33+i
+        last[i] = b
+        }
+    started = 1
+    t += n
+}
+' "${1:--}"
@@ -38,6 +38,7 @@ extern u32 _srelocate   [];     //data (initialized)
 extern u32 _erelocate   [];
 extern u32 _szero       [];     //bss (zeroed)
 extern u32 _ezero       [];
+extern u32 _sstack      [];     //stack bottom (end of ram use)
 extern u32 _estack      [];     //stack address
 
 //setup linker symbols with nicer names
@@ -50,8 +51,13 @@ SCA dataStart           { _srelocate };
 SCA dataEnd             { _erelocate };
 SCA bssStart            { _szero };
 SCA bssEnd              { _ezero };
+SCA stackBottom         { _sstack };
 SCA stackTop            { _estack };
 
+//unused stack filled with this value, so peak stack use can be found later
+//(same value in Memory.hpp)
+static constexpr u32  STACK_PAINT       {0xA5A5A5A5};
+
 //SCB.VTOR (vector table offset), SCB.AIRCR (for swReset)
 static volatile auto& VTOR              { *(volatile u32*)0xE000ED08 };
 static volatile auto& AIRCR             { *(volatile u32*)0xE000ED0C };
@@ -64,6 +70,8 @@ static constexpr u32  CYCLES_PER_LOOP   {4};
     function declarations
 -----------------------------------------------------------------------------*/
 int main();
+void boardInit();
+void preinit();
 static void resetFunc();
 static void errorFunc();
 extern "C" void __libc_init_array();
@@ -161,20 +169,38 @@ initRamData     ()
                 setmem( bssStart, bssEnd, 0 );
                 }
 
+                IIA
+initStackPaint  ()
+                {
+                //paint from the stack bottom to just below the stack in use now
+                //(leave the first 2 words as-is, random32 may use them as a seed)
+                u32* sp;
+                asm( "MRS %0, msp" : "=r" (sp) );
+                setmem( &stackBottom[2], sp - 16, STACK_PAINT );
+                }
+
                 IIA
 initRam         ()
                 {
                 initRamDebug();
                 initRamVectors();
                 initRamData();
+                initStackPaint();
                 }
 
+                //app init before any c++ constructors (app pin tables, etc.),
+                //after boardInit- app defines its own if needed
+                [[ gnu::weak ]] void
+preinit         () {}
+
                 [[ using gnu : used, noreturn ]]
                 static void
 resetFunc       ()
                 {
                 delayMS(5000);          //allow time to allow swd hot-plug
                 initRam();              //ram vectors, normal data/bss init, etc.
+                boardInit();            //board pins (Boards.hpp), always
+                preinit();              //app init, before constructors
                 __libc_init_array();    //libc init, c++ constructors, etc.
 
                 //C++ will not allow using main with pendatic on, so disable pedantic
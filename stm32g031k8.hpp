@@ -20,25 +20,55 @@ PIN             {
                 SWDIO = PA13, SWCLK = PA14, //+ any alias names
                 };
 
+                //gpio ports A-F (pin/16 = 0-5, D,E not on this mcu), size
+                //for any per port array indexed by pin/16
+                SCA PORTS{ 6 };
+
 }
 
+#include "Gpio.hpp" //PINS::ALTFUNC for the peripheral pin tables below
+
 /*=============================================================
     Lptim instances available for this mcu
 =============================================================*/
 using lptimT = struct {
-    LPTIM_TypeDef* lptim;
-    PINS::PIN in1;
+    LPTIM_TypeDef*  lptim;
+    PINS::PIN       in1;
+    PINS::ALTFUNC   in1AltFunc;
+    PINS::PIN       out;            //LPTIMx_OUT
+    PINS::ALTFUNC   outAltFunc;
     //enough for now
     };
 
-static constexpr lptimT Lptim1 { LPTIM1, PINS::PB5 };
-static constexpr lptimT Lptim2 { LPTIM2, PINS::PB1 };
+static constexpr lptimT Lptim1 { LPTIM1, PINS::PB5, PINS::AF5, PINS::PB2, PINS::AF5 };
+static constexpr lptimT Lptim2 { LPTIM2, PINS::PB1, PINS::AF5, PINS::PA4, PINS::AF5 };
 //alternate names
 auto& Lptim1_PB5{ Lptim1 };
 auto& Lptim2_PB1{ Lptim2 };
 
 
 
+/*=============================================================
+    Tim instances available for this mcu
+
+    dmaUp - DMAMUX request id for the timer update event
+            (TIM14 has no dma request)
+=============================================================*/
+using timT = struct {
+    TIM_TypeDef*    tim;
+    IRQn_Type       irqn;
+    uint8_t         dmaUp;
+    };
+
+static constexpr timT Tim1  { TIM1,  TIM1_BRK_UP_TRG_COM_IRQn, 25 };
+static constexpr timT Tim2  { TIM2,  TIM2_IRQn,  31 }; //32bit
+static constexpr timT Tim3  { TIM3,  TIM3_IRQn,  37 };
+static constexpr timT Tim14 { TIM14, TIM14_IRQn, 0 };
+static constexpr timT Tim16 { TIM16, TIM16_IRQn, 46 };
+static constexpr timT Tim17 { TIM17, TIM17_IRQn, 49 };
+
+
+
 /*=============================================================
     Uart instances available for this mcu
 
@@ -55,7 +85,6 @@ auto& Lptim2_PB1{ Lptim2 };
     a little verbose, and would get worse for all the other
     uart pins, but will do for now
 =============================================================*/
-#include "Gpio.hpp"
 //struct with info about specific uart (only tx/rx pins)
 using uartT = struct {
     USART_TypeDef*  uart;
@@ -109,3 +138,27 @@ static constexpr uartT Uart2_A14A15 {
     PINS::PA14, PINS::AF1,
     PINS::PA15, PINS::AF1,
     };
+
+
+/*=============================================================
+    Tim encoder mode instances (CH1/CH2 pins)
+
+    TimN_Enc_AB - pin names specified in instance name
+
+    TIM1 CH1 - PA8/AF2, CH2 - PA9/AF2
+    TIM2 CH1 - PA0/AF2, CH2 - PA1/AF2 (32bit counter)
+    TIM3 CH1 - PA6/AF1, CH2 - PA7/AF1
+         CH1 - PB4/AF1, CH2 - PB5/AF1
+=============================================================*/
+using timEncT = struct {
+    timT            tim;
+    PINS::PIN       pinA;
+    PINS::ALTFUNC   altFuncA;
+    PINS::PIN       pinB;
+    PINS::ALTFUNC   altFuncB;
+    };
+
+static constexpr timEncT Tim1_Enc_A8A9 { Tim1, PINS::PA8, PINS::AF2, PINS::PA9, PINS::AF2 };
+static constexpr timEncT Tim2_Enc_A0A1 { Tim2, PINS::PA0, PINS::AF2, PINS::PA1, PINS::AF2 };
+static constexpr timEncT Tim3_Enc_A6A7 { Tim3, PINS::PA6, PINS::AF1, PINS::PA7, PINS::AF1 };
+static constexpr timEncT Tim3_Enc_B4B5 { Tim3, PINS::PB4, PINS::AF1, PINS::PB5, PINS::AF1 };
@@ -0,0 +1,121 @@
+//quadtable_test.cpp - host test, replays synthetic quadrature traces
+//through QuadTable the same way EncoderQuad::isr decodes them
+//(make -C tests)
+
+#include <cstdint>
+#include <cstdio>
+
+using u8    = uint8_t;
+using i8    = int8_t;
+using u32   = uint32_t;
+using i32   = int32_t;
+
+#include "QuadTable.hpp"
+
+/*-------------------------------------------------------------
+    decoder, as EncoderQuad (state change -> table lookup)
+--------------------------------------------------------------*/
+struct Decoder {
+    u8 state{0};
+    i32 count{0};
+    u32 errors{0};
+
+    void
+    edge (u8 s)
+        {
+        if( s == state ) return;
+        auto v = QuadTable::tbl[(state<<2) | s];
+        state = s;
+        if( v == QuadTable::ERR ) errors++; else count += v;
+        }
+    };
+
+/*-------------------------------------------------------------
+    trace generator- gray code steps, optional bounce on the
+    pin that changes (new,old,new... before settling)
+--------------------------------------------------------------*/
+static u32 seed_{ 12345 };
+static u32 rnd (u32 n) { seed_ = seed_*1664525 + 1013904223; return (seed_>>16) % n; }
+
+//forward (+1) sequence is 00 -> 10 -> 11 -> 01 -> 00 (A=bit1, B=bit0)
+static constexpr u8 fwd[4]{ 0b00, 0b10, 0b11, 0b01 };
+
+struct Trace {
+    u8 pos{0};      //index into fwd
+    i32 net{0};
+
+    void
+    step (Decoder& d, int dir, u8 maxBounce)
+        {
+        u8 old = fwd[pos];
+        pos = (pos + (dir > 0 ? 1 : 3)) & 3;
+        u8 now = fwd[pos];
+        for( auto n = rnd(maxBounce+1); n; n-- ){ d.edge( now ); d.edge( old ); }
+        d.edge( now );
+        net += dir;
+        }
+    };
+
+static int fails_;
+
+static void
+check (bool ok, const char* what)
+    {
+    printf( "%s  %s\n", ok ? "pass" : "FAIL", what );
+    if( not ok ) fails_++;
+    }
+
+int
+main ()
+    {
+    //table- no change is 0, reverse transition is the negative
+    {
+    bool ok = true;
+    for( u8 a = 0; a < 4; a++ ){
+        if( QuadTable::tbl[(a<<2)|a] != 0 ) ok = false;
+        for( u8 b = 0; b < 4; b++ ){
+            auto v = QuadTable::tbl[(a<<2)|b];
+            auto r = QuadTable::tbl[(b<<2)|a];
+            if( v == QuadTable::ERR ? r != QuadTable::ERR : v != -r ) ok = false;
+            }
+        }
+    check( ok, "table symmetry" );
+    }
+
+    static constexpr u8 bounces[]{ 0, 5 }; //max bounces per edge
+
+    //forward, clean and bouncy
+    for( u8 bounce : bounces ){
+        Decoder d; Trace t;
+        for( auto i = 0; i < 1000; i++ ) t.step( d, +1, bounce );
+        check( d.count == 1000 and d.errors == 0, bounce ? "forward 1000, bouncy" : "forward 1000" );
+        }
+
+    //reverse, clean and bouncy
+    for( u8 bounce : bounces ){
+        Decoder d; Trace t;
+        for( auto i = 0; i < 1000; i++ ) t.step( d, -1, bounce );
+        check( d.count == -1000 and d.errors == 0, bounce ? "reverse 1000, bouncy" : "reverse 1000" );
+        }
+
+    //random walk with bounce, count follows the net steps
+    {
+    Decoder d; Trace t;
+    for( auto i = 0; i < 10000; i++ ) t.step( d, rnd(2) ? 1 : -1, 3 );
+    check( d.count == t.net and d.errors == 0, "random walk 10000, bouncy" );
+    }
+
+    //illegal double step (both pins change, a missed state)
+    {
+    Decoder d; Trace t;
+    t.step( d, +1, 0 );                     //00 -> 10
+    d.edge( 0b01 );                         //10 -> 01 skips 11
+    check( d.count == 1 and d.errors == 1, "double step counted as error" );
+    t.pos = 3;                              //decoder continues from 01
+    t.step( d, +1, 0 );                     //01 -> 00
+    check( d.count == 2 and d.errors == 1, "continues after error" );
+    }
+
+    printf( fails_ ? "%d FAILED\n" : "all passed\n", fails_ );
+    return fails_ != 0;
+    }
@@ -0,0 +1,103 @@
+//speedcalc_test.cpp - host test, feeds SpeedCalc (EncoderSpeed math) the
+//edges of a constant acceleration ramp and checks velocity and
+//acceleration come out as Q24.8 counts/sec and counts/sec^2
+//(make -C tests)
+
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+
+using i32   = int32_t;
+using u32   = uint32_t;
+using i64   = int64_t;
+
+#include "SpeedCalc.hpp"
+
+static int fails_;
+
+static void
+check (bool ok, const char* what)
+    {
+    printf( "%s  %s\n", ok ? "pass" : "FAIL", what );
+    if( not ok ) fails_++;
+    }
+
+/*-------------------------------------------------------------
+    ramp- from rest at constant acceleration (counts/sec^2, sign is
+    the direction), edge k (1..) is at sqrt(2k/|acc|) sec, ticks
+    every tickUs, timer is mask+1 range (16 or 32 bits)
+
+    velocity checked against acc*t at each tick after warmUs (M/T
+    measures the mean over the last edge window, so is slightly
+    behind), acceleration as the mean of the samples after warmUs
+    (each sample has edge window jitter, the mean does not)
+--------------------------------------------------------------*/
+struct RampResult { double maxVelErr, meanAcc; i32 lastVel; };
+
+static RampResult
+ramp (double acc, u32 mask, u32 tickUs, u32 warmUs, u32 endUs)
+    {
+    SpeedCalc calc{ mask, 500000, 0 };
+    double a = std::fabs( acc );
+    i32 dir = acc < 0 ? -1 : 1;
+    i32 edges = 0; u32 tEdge = 0;
+    double maxErr = 0, sumAcc = 0; u32 nAcc = 0; i32 lastVel = 0;
+    for( u32 t = tickUs; t <= endUs; t += tickUs ){
+        while( true ){ //edges up to this tick
+            double te = std::sqrt( 2.0*(std::abs( edges ) + 1)/a )*1e6;
+            if( te > t ) break;
+            edges += dir;
+            tEdge = (u32)te;
+            }
+        auto r = calc.update( edges, tEdge bitand mask, t bitand mask );
+        lastVel = r.velocity;
+        if( t < warmUs ) continue;
+        double v = r.velocity/256.0, vExp = acc*t/1e6;
+        double err = std::fabs( v - vExp )/std::fabs( vExp );
+        if( err > maxErr ) maxErr = err;
+        sumAcc += r.acceleration/256.0;
+        nAcc++;
+        }
+    return { maxErr, sumAcc/nAcc, lastVel };
+    }
+
+int
+main ()
+    {
+    //known ramps, both directions, 32bit and 16bit (wrapping) timer
+    struct { double acc; u32 mask; const char* name; } static constexpr ramps[]{
+        {  1000, 0xFFFFFFFF, "ramp +1000 counts/s^2, 32bit timer" },
+        { -1000, 0xFFFFFFFF, "ramp -1000 counts/s^2, 32bit timer" },
+        {  20000, 0xFFFF,    "ramp +20000 counts/s^2, 16bit timer" },
+        { -20000, 0xFFFF,    "ramp -20000 counts/s^2, 16bit timer" },
+        };
+    for( auto& rp : ramps ){
+        auto r = ramp( rp.acc, rp.mask, 5000, 500000, 2000000 );
+        double accErr = std::fabs( r.meanAcc - rp.acc )/std::fabs( rp.acc );
+        printf( "      %s: velocity err max %.3f%%, acceleration mean %.1f\n",
+                rp.name, r.maxVelErr*100, r.meanAcc );
+        check( r.maxVelErr < 0.01 and accErr < 0.02, rp.name );
+        }
+
+    //acceleration above the old Q16.16 saturation point (~32768 counts/s^2)
+    {
+    auto r = ramp( 100000, 0xFFFFFFFF, 5000, 200000, 1000000 );
+    double accErr = std::fabs( r.meanAcc - 100000 )/100000;
+    printf( "      ramp +100000: acceleration mean %.1f\n", r.meanAcc );
+    check( accErr < 0.02, "ramp +100000 counts/s^2, not saturated" );
+    }
+
+    //edges stop- velocity decays to no more than 1 count since the last
+    //edge, then 0 after the timeout
+    {
+    SpeedCalc calc{ 0xFFFFFFFF, 500000, 0 };
+    i32 e = 0;
+    for( u32 t = 1000; t <= 100000; t += 1000 ) calc.update( ++e, t, t ); //1000 counts/s
+    auto r1 = calc.update( e, 100000, 110000 );                            //10ms no edges
+    auto r2 = calc.update( e, 100000, 700000 );                            //past timeout
+    check( r1.velocity == (i32)(256*100) and r2.velocity == 0, "decay after edges stop, 0 after timeout" );
+    }
+
+    printf( fails_ ? "%d FAILED\n" : "all passed\n", fails_ );
+    return fails_ != 0;
+    }
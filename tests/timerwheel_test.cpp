@@ -0,0 +1,173 @@
+//timerwheel_test.cpp - host test, TimerWheel (LptimTimers list part) with
+//timer functions that cancel or restart other timers in the slot being run
+//(make -C tests)
+
+#include <cstdint>
+#include <cstdio>
+#include <unistd.h>
+
+using u8    = uint8_t;
+using u32   = uint32_t;
+using i32   = int32_t;
+
+//as Util.hpp
+inline u8 ctz (u32 v) { return __builtin_ctz( v ); }
+
+#include "TimerWheel.hpp"
+
+using Timer = TimerWheel::Timer;
+
+static int fails_;
+
+static void
+check (bool ok, const char* what)
+    {
+    printf( "%s  %s\n", ok ? "pass" : "FAIL", what );
+    if( not ok ) fails_++;
+    }
+
+/*-------------------------------------------------------------
+    timers a,b,c in the same slot (all due at once), functions
+    count their calls and do whatever action is set for them
+--------------------------------------------------------------*/
+static TimerWheel wheel;
+static u32 now_;
+static u32 runs[3];
+static void(*action[3])();
+
+static Timer a{ []{ runs[0]++; if( action[0] ) action[0](); } };
+static Timer b{ []{ runs[1]++; if( action[1] ) action[1](); } };
+static Timer c{ []{ runs[2]++; if( action[2] ) action[2](); } };
+static Timer* const abc[]{ &a, &b, &c };
+
+static void
+start (Timer& t, u32 ticks, bool periodic = false)
+    {
+    wheel.remove( t );
+    t.deadline = now_ + ticks;
+    t.period = periodic ? ticks : 0;
+    wheel.add( t );
+    }
+
+//advance time 1 tick at a time, running the wheel each tick
+static void
+runTo (u32 t) { while( now_ != t ){ now_++; wheel.run( now_ ); } }
+
+//advance time, one run (timers not yet due are relinked at the list head
+//when their slot is run, so reverse order- one run keeps the start order)
+static void
+jumpTo (u32 t) { now_ = t; wheel.run( now_ ); }
+
+static void
+reset ()
+    {
+    for( auto t : abc ) wheel.remove( *t );
+    for( auto& r : runs ) r = 0;
+    for( auto& f : action ) f = nullptr;
+    }
+
+//all slots empty (next deadline is the max wait) and no timer active
+static bool
+isEmpty ()
+    {
+    return wheel.next( now_, 0x8000 ) == now_ + 0x8000 and
+        not TimerWheel::isActive( a ) and not TimerWheel::isActive( b ) and not TimerWheel::isActive( c );
+    }
+
+int
+main ()
+    {
+    alarm( 10 ); //a corrupted list can loop forever, so fail (SIGALRM) instead
+    wheel.init( now_ );
+
+    //added in order c,b,a so a is run first (list head), then b, then c
+    //(jumpTo, so the slot is only run once they are all due)
+    auto startAll = [](u32 ticks){ start( c, ticks ); start( b, ticks ); start( a, ticks ); };
+
+    //plain run, all once
+    {
+    reset(); startAll( 100 );
+    jumpTo( now_ + 200 );
+    check( runs[0] == 1 and runs[1] == 1 and runs[2] == 1 and isEmpty(), "same slot, all run once" );
+    }
+
+    //a cancels b (not yet run, in the pending list)
+    {
+    reset(); startAll( 100 );
+    action[0] = []{ wheel.remove( b ); };
+    jumpTo( now_ + 200 );
+    check( runs[0] == 1 and runs[1] == 0 and runs[2] == 1 and isEmpty(), "cancel a pending sibling" );
+    }
+
+    //a cancels c (last in the pending list)
+    {
+    reset(); startAll( 100 );
+    action[0] = []{ wheel.remove( c ); };
+    jumpTo( now_ + 200 );
+    check( runs[0] == 1 and runs[1] == 1 and runs[2] == 0 and isEmpty(), "cancel the last pending sibling" );
+    }
+
+    //a restarts b (not yet run) for later, b runs once at its new deadline
+    {
+    reset(); startAll( 100 );
+    static u32 restartAt, bRanAt;
+    action[0] = []{ restartAt = now_; start( b, 3000 ); };
+    action[1] = []{ bRanAt = now_; };
+    jumpTo( now_ + 200 );
+    bool notYet = runs[1] == 0 and TimerWheel::isActive( b );
+    runTo( now_ + 4000 );
+    check( notYet and runs[0] == 1 and runs[1] == 1 and runs[2] == 1 and
+           bRanAt == restartAt + 3000 and isEmpty(), "restart a pending sibling" );
+    }
+
+    //a restarts b due now, b runs once- on the next run, as it is relinked
+    //to the slot, not the pending list (LptimTimers::service runs again
+    //while a timer is due)
+    {
+    reset(); startAll( 100 );
+    action[0] = []{ start( b, 0 ); };
+    jumpTo( now_ + 200 );
+    bool notYet = runs[1] == 0 and wheel.next( now_, 0x8000 ) == now_;
+    jumpTo( now_ );
+    check( notYet and runs[0] == 1 and runs[1] == 1 and runs[2] == 1 and isEmpty(), "restart a pending sibling, due now" );
+    }
+
+    //periodic a cancels itself on its 3rd run, b and c periodic are
+    //cancelled by a on its 2nd run (whether already run that time or
+    //still pending), so never run again
+    {
+    reset();
+    start( c, 50, true ); start( b, 50, true ); start( a, 50, true );
+    static u32 bAt, cAt;
+    action[0] = []{
+        if( runs[0] == 2 ){ wheel.remove( b ); wheel.remove( c ); bAt = runs[1]; cAt = runs[2]; }
+        if( runs[0] == 3 ) wheel.remove( a );
+        };
+    runTo( now_ + 1000 );
+    check( runs[0] == 3 and runs[1] == bAt and runs[2] == cAt and bAt >= 1 and bAt <= 2 and
+           cAt >= 1 and cAt <= 2 and isEmpty(), "periodic cancel self and siblings" );
+    }
+
+    //many timers over several turns of the wheel, each restarts the next
+    //one for a different time, run order and counts checked
+    {
+    reset();
+    static Timer ts[8]; static u32 counts[8], last, order;
+    static bool inOrder = true;
+    for( u32 i = 0; i < 8; i++ ) ts[i].func = []{};
+    ts[0].func = []{ counts[0]++; if( last != 3 and order ) inOrder = false; last = 0; order++; start( ts[1], 1500 ); };
+    ts[1].func = []{ counts[1]++; if( last != 0 ) inOrder = false; last = 1; order++; wheel.remove( ts[2] ); start( ts[2], 37 ); };
+    ts[2].func = []{ counts[2]++; if( last != 1 ) inOrder = false; last = 2; order++; start( ts[3], 40000 ); };
+    ts[3].func = []{ counts[3]++; if( last != 2 ) inOrder = false; last = 3; order++; start( ts[0], 5 ); };
+    start( ts[0], 10 );
+    runTo( now_ + 1000000 );
+    u32 n = order/4;
+    bool ok = inOrder and n > 10;
+    for( u32 i = 0; i < 4; i++ ) if( counts[i] < n or counts[i] > n+1 ) ok = false;
+    for( u32 i = 0; i < 4; i++ ) wheel.remove( ts[i] );
+    check( ok and isEmpty(), "chain of restarts over many turns" );
+    }
+
+    printf( fails_ ? "%d FAILED\n" : "all passed\n", fails_ );
+    return fails_ != 0;
+    }